@@ -0,0 +1,403 @@
+// mockProviderServer.ts
+import http from "node:http"
+import { AddressInfo } from "node:net"
+import { option } from "./stats"
+
+export interface MockProviderOptions {
+  port: number              // 0 picks a free port
+  ttfbMs: number            // Delay before the first response byte
+  tokensPerSecond: number   // Output rate once generation starts, 0 sends everything at once
+  failureRate: number       // Fraction of requests answered with failureStatus, 0-1
+  failureStatus: number
+}
+
+export interface MockProviderServer {
+  url: string
+  // Base URLs to export as OPENAI_BASE_URL, ANTHROPIC_BASE_URL and GEMINI_BASE_URL
+  baseUrls: { openai: string; anthropic: string; gemini: string }
+  requests: number
+  failures: number
+  close: () => Promise<void>
+}
+
+export const DEFAULT_MOCK_OPTIONS: MockProviderOptions = {
+  port: 0,
+  ttfbMs: 400,
+  tokensPerSecond: 150,
+  failureRate: 0,
+  failureStatus: 500
+}
+
+// Approximate characters per output token, used to pace streamed text
+const CHARS_PER_TOKEN = 4
+
+// Values returned for the fields of the app's response schemas
+const CANNED_FIELDS: Record<string, unknown> = {
+  problem_statement:
+    "Given an array of integers nums and an integer target, return the indices of the two numbers that add up to target.",
+  constraints: "2 <= nums.length <= 10^4, -10^9 <= nums[i] <= 10^9, exactly one valid answer exists.",
+  example_input: "nums = [2, 7, 11, 15], target = 9",
+  example_output: "[0, 1]",
+  code: [
+    "def two_sum(nums, target):",
+    "    # Map each value to its index as we scan",
+    "    seen = {}",
+    "    for index, value in enumerate(nums):",
+    "        complement = target - value",
+    "        if complement in seen:",
+    "            return [seen[complement], index]",
+    "        seen[value] = index",
+    "    return []"
+  ].join("\n"),
+  thoughts: [
+    "A brute-force pair check is quadratic, so trade memory for time.",
+    "Storing each value's index lets us find the complement in constant time.",
+    "A single pass is enough because the complement of a later value was stored earlier."
+  ],
+  time_complexity:
+    "O(n) because every element is visited once. Each dictionary lookup and insert is O(1) on average.",
+  space_complexity:
+    "O(n) because the dictionary can hold every element. This happens when the pair is found last."
+}
+
+const DEBUG_MARKDOWN = `### Issues Identified
+- The loop returns before checking the final element.
+
+### Specific Improvements and Corrections
+- Iterate over the whole array before returning an empty result.
+
+### Optimizations
+- None needed; the solution is already linear.
+
+### Explanation of Changes Needed
+The early return skipped valid pairs that end at the last index.
+
+### Key Points
+- Always test the boundary elements.`
+
+/**
+ * Build a value matching a JSON schema from the canned fields, keeping the
+ * schema's property order so streamed output matches a real model's
+ */
+function buildFromSchema(schema: any, key = ""): unknown {
+  if (key in CANNED_FIELDS) return CANNED_FIELDS[key]
+
+  const type = String(schema?.type || "").toLowerCase()
+  if (type === "object" || schema?.properties) {
+    const value: Record<string, unknown> = {}
+    for (const [property, propertySchema] of Object.entries(schema.properties || {})) {
+      value[property] = buildFromSchema(propertySchema, property)
+    }
+    return value
+  }
+  if (type === "array") return [buildFromSchema(schema.items)]
+  if (type === "number" || type === "integer") return 0
+  if (type === "boolean") return false
+  return "mock"
+}
+
+/**
+ * Response text for a request: JSON when it carries a response schema,
+ * free-form markdown otherwise
+ */
+function buildResponseText(schema: unknown): string {
+  return schema ? JSON.stringify(buildFromSchema(schema)) : DEBUG_MARKDOWN
+}
+
+function splitIntoTokens(text: string): string[] {
+  const tokens: string[] = []
+  for (let offset = 0; offset < text.length; offset += CHARS_PER_TOKEN) {
+    tokens.push(text.slice(offset, offset + CHARS_PER_TOKEN))
+  }
+  return tokens
+}
+
+const sleep = (ms: number) => new Promise((resolve) => setTimeout(resolve, ms))
+
+type WireFormat = "openai" | "anthropic" | "gemini"
+
+interface ParsedRequest {
+  format: WireFormat
+  stream: boolean
+  model: string
+  schema: unknown
+}
+
+/**
+ * Identify which provider API a request targets from its path and body
+ */
+function parseRequest(pathname: string, search: string, body: any): ParsedRequest | null {
+  if (pathname.endsWith("/chat/completions")) {
+    return {
+      format: "openai",
+      stream: Boolean(body.stream),
+      model: body.model,
+      schema: body.response_format?.json_schema?.schema
+    }
+  }
+
+  if (pathname.endsWith("/messages")) {
+    const tool = (body.tools || []).find((candidate: any) => candidate.name === body.tool_choice?.name)
+    return {
+      format: "anthropic",
+      stream: Boolean(body.stream),
+      model: body.model,
+      schema: tool?.input_schema
+    }
+  }
+
+  const gemini = pathname.match(/\/models\/([^/:]+):(generateContent|streamGenerateContent)$/)
+  if (gemini) {
+    return {
+      format: "gemini",
+      stream: gemini[2] === "streamGenerateContent" && search.includes("alt=sse"),
+      model: gemini[1],
+      schema: body.generationConfig?.responseSchema
+    }
+  }
+
+  return null
+}
+
+function sendJson(res: http.ServerResponse, status: number, payload: unknown): void {
+  res.writeHead(status, { "Content-Type": "application/json" })
+  res.end(JSON.stringify(payload))
+}
+
+function sendFailure(res: http.ServerResponse, format: WireFormat, status: number): void {
+  const message = `Injected failure (${status})`
+  if (format === "anthropic") {
+    sendJson(res, status, { type: "error", error: { type: "api_error", message } })
+  } else if (format === "gemini") {
+    sendJson(res, status, { error: { code: status, message, status: "INTERNAL" } })
+  } else {
+    sendJson(res, status, { error: { message, type: "server_error", code: null } })
+  }
+}
+
+/**
+ * Write a complete, non-streaming response body in the provider's format
+ */
+function sendCompletion(res: http.ServerResponse, request: ParsedRequest, text: string): void {
+  const outputTokens = Math.ceil(text.length / CHARS_PER_TOKEN)
+
+  if (request.format === "openai") {
+    sendJson(res, 200, {
+      id: "chatcmpl-mock",
+      object: "chat.completion",
+      created: Math.floor(Date.now() / 1000),
+      model: request.model,
+      choices: [{ index: 0, message: { role: "assistant", content: text }, finish_reason: "stop" }],
+      usage: { prompt_tokens: 1000, completion_tokens: outputTokens, total_tokens: 1000 + outputTokens }
+    })
+  } else if (request.format === "anthropic") {
+    sendJson(res, 200, {
+      id: "msg_mock",
+      type: "message",
+      role: "assistant",
+      model: request.model,
+      content: request.schema
+        ? [{ type: "tool_use", id: "toolu_mock", name: "response", input: JSON.parse(text) }]
+        : [{ type: "text", text }],
+      stop_reason: request.schema ? "tool_use" : "end_turn",
+      stop_sequence: null,
+      usage: { input_tokens: 1000, output_tokens: outputTokens }
+    })
+  } else {
+    sendJson(res, 200, {
+      candidates: [{ content: { role: "model", parts: [{ text }] }, finishReason: "STOP" }]
+    })
+  }
+}
+
+/**
+ * Stream a response as server-sent events in the provider's format
+ */
+async function streamCompletion(
+  res: http.ServerResponse,
+  request: ParsedRequest,
+  text: string,
+  tokensPerSecond: number
+): Promise<void> {
+  res.writeHead(200, {
+    "Content-Type": "text/event-stream",
+    "Cache-Control": "no-cache",
+    Connection: "keep-alive"
+  })
+
+  const writeEvent = (data: unknown, event?: string) => {
+    res.write(`${event ? `event: ${event}\n` : ""}data: ${JSON.stringify(data)}\n\n`)
+  }
+
+  if (request.format === "anthropic") {
+    writeEvent({
+      type: "message_start",
+      message: {
+        id: "msg_mock",
+        type: "message",
+        role: "assistant",
+        model: request.model,
+        content: [],
+        stop_reason: null,
+        stop_sequence: null,
+        usage: { input_tokens: 1000, output_tokens: 1 }
+      }
+    }, "message_start")
+    writeEvent({
+      type: "content_block_start",
+      index: 0,
+      content_block: request.schema
+        ? { type: "tool_use", id: "toolu_mock", name: "response", input: {} }
+        : { type: "text", text: "" }
+    }, "content_block_start")
+  }
+
+  const tokenDelayMs = tokensPerSecond > 0 ? 1000 / tokensPerSecond : 0
+  for (const token of splitIntoTokens(text)) {
+    if (res.destroyed) return
+
+    if (request.format === "openai") {
+      writeEvent({
+        id: "chatcmpl-mock",
+        object: "chat.completion.chunk",
+        created: Math.floor(Date.now() / 1000),
+        model: request.model,
+        choices: [{ index: 0, delta: { content: token }, finish_reason: null }]
+      })
+    } else if (request.format === "anthropic") {
+      writeEvent({
+        type: "content_block_delta",
+        index: 0,
+        delta: request.schema
+          ? { type: "input_json_delta", partial_json: token }
+          : { type: "text_delta", text: token }
+      }, "content_block_delta")
+    } else {
+      writeEvent({ candidates: [{ content: { role: "model", parts: [{ text: token }] } }] })
+    }
+
+    if (tokenDelayMs > 0) await sleep(tokenDelayMs)
+  }
+
+  if (request.format === "openai") {
+    writeEvent({
+      id: "chatcmpl-mock",
+      object: "chat.completion.chunk",
+      created: Math.floor(Date.now() / 1000),
+      model: request.model,
+      choices: [{ index: 0, delta: {}, finish_reason: "stop" }]
+    })
+    res.write("data: [DONE]\n\n")
+  } else if (request.format === "anthropic") {
+    writeEvent({ type: "content_block_stop", index: 0 }, "content_block_stop")
+    writeEvent({
+      type: "message_delta",
+      delta: { stop_reason: request.schema ? "tool_use" : "end_turn", stop_sequence: null },
+      usage: { output_tokens: Math.ceil(text.length / CHARS_PER_TOKEN) }
+    }, "message_delta")
+    writeEvent({ type: "message_stop" }, "message_stop")
+  } else {
+    writeEvent({ candidates: [{ content: { role: "model", parts: [{ text: "" }] }, finishReason: "STOP" }] })
+  }
+  res.end()
+}
+
+/**
+ * Start a local server that answers OpenAI chat completions, Anthropic
+ * messages and Gemini generateContent requests with canned output, so the
+ * processing pipeline can run offline with controllable latency and failures.
+ */
+export function startMockProviderServer(
+  overrides: Partial<MockProviderOptions> = {}
+): Promise<MockProviderServer> {
+  const options = { ...DEFAULT_MOCK_OPTIONS }
+  for (const [key, value] of Object.entries(overrides)) {
+    if (value !== undefined) (options as Record<string, number>)[key] = value
+  }
+  let handle: MockProviderServer
+
+  const server = http.createServer(async (req, res) => {
+    // Connection pre-warming only needs the socket
+    if (req.method === "HEAD") {
+      res.writeHead(204)
+      res.end()
+      return
+    }
+
+    const chunks: Buffer[] = []
+    for await (const chunk of req) chunks.push(chunk as Buffer)
+
+    let body: any
+    try {
+      body = JSON.parse(Buffer.concat(chunks).toString("utf8") || "{}")
+    } catch (error) {
+      sendJson(res, 400, { error: { message: "Request body is not valid JSON" } })
+      return
+    }
+
+    const url = new URL(req.url || "/", "http://localhost")
+    const request = parseRequest(url.pathname, url.search, body)
+    if (!request) {
+      sendJson(res, 404, { error: { message: `No mock for ${req.method} ${url.pathname}` } })
+      return
+    }
+
+    handle.requests++
+    await sleep(options.ttfbMs)
+    if (res.destroyed) return
+
+    if (Math.random() < options.failureRate) {
+      handle.failures++
+      sendFailure(res, request.format, options.failureStatus)
+      return
+    }
+
+    const text = buildResponseText(request.schema)
+    if (request.stream) {
+      await streamCompletion(res, request, text, options.tokensPerSecond)
+    } else {
+      // Non-streaming responses still take as long as generating the output
+      if (options.tokensPerSecond > 0) {
+        await sleep((splitIntoTokens(text).length / options.tokensPerSecond) * 1000)
+      }
+      if (!res.destroyed) sendCompletion(res, request, text)
+    }
+  })
+
+  return new Promise((resolve, reject) => {
+    server.once("error", reject)
+    server.listen(options.port, "127.0.0.1", () => {
+      const { port } = server.address() as AddressInfo
+      const url = `http://127.0.0.1:${port}`
+      handle = {
+        url,
+        baseUrls: { openai: `${url}/v1`, anthropic: url, gemini: url },
+        requests: 0,
+        failures: 0,
+        close: () =>
+          new Promise<void>((resolveClose) => {
+            server.closeAllConnections()
+            server.close(() => resolveClose())
+          })
+      }
+      resolve(handle)
+    })
+  })
+}
+
+// Standalone use: point the app at the printed base URLs
+if (require.main === module) {
+  const numeric = (name: string, fallback: number) => Number(option(name, String(fallback)))
+  startMockProviderServer({
+    port: numeric("port", 8788),
+    ttfbMs: numeric("ttfb", DEFAULT_MOCK_OPTIONS.ttfbMs),
+    tokensPerSecond: numeric("tokens-per-second", DEFAULT_MOCK_OPTIONS.tokensPerSecond),
+    failureRate: numeric("failure-rate", DEFAULT_MOCK_OPTIONS.failureRate),
+    failureStatus: numeric("failure-status", DEFAULT_MOCK_OPTIONS.failureStatus)
+  }).then((server) => {
+    console.log(`Mock provider server listening on ${server.url}`)
+    console.log(`  OPENAI_BASE_URL=${server.baseUrls.openai}`)
+    console.log(`  ANTHROPIC_BASE_URL=${server.baseUrls.anthropic}`)
+    console.log(`  GEMINI_BASE_URL=${server.baseUrls.gemini}`)
+  })
+}
@@ -0,0 +1,237 @@
+// pipeline.ts
+// End-to-end latency benchmark for the processing pipeline. Runs inside
+// Electron (nativeImage is needed for hashing and image optimization) against
+// the local mock provider server, so it needs no API keys or network.
+//
+//   npm run bench:pipeline -- --provider all --iterations 20 --ttfb 400
+import fs from "node:fs"
+import os from "node:os"
+import path from "node:path"
+import { app } from "electron"
+import { startMockProviderServer, MockProviderServer } from "./mockProviderServer"
+import { flag, option, summarize } from "./stats"
+
+type ProviderId = "openai" | "gemini" | "anthropic"
+
+// Mirrors state.PROCESSING_EVENTS in electron/main.ts
+const PROCESSING_EVENTS = {
+  UNAUTHORIZED: "processing-unauthorized",
+  NO_SCREENSHOTS: "processing-no-screenshots",
+  OUT_OF_CREDITS: "out-of-credits",
+  API_KEY_INVALID: "api-key-invalid",
+  INITIAL_START: "initial-start",
+  PROBLEM_EXTRACTED: "problem-extracted",
+  SOLUTION_SUCCESS: "solution-success",
+  SOLUTION_CHUNK: "solution-chunk",
+  INITIAL_SOLUTION_ERROR: "solution-error",
+  DEBUG_START: "debug-start",
+  DEBUG_SUCCESS: "debug-success",
+  DEBUG_ERROR: "debug-error"
+} as const
+
+interface RunTimings {
+  capture?: number          // Capture request to preview ready, per screenshot (window hide is stubbed)
+  extraction?: number       // Start to PROBLEM_EXTRACTED
+  firstCodeToken?: number   // Start to the first streamed code chunk
+  solution?: number         // PROBLEM_EXTRACTED to SOLUTION_SUCCESS
+  total?: number            // Start to SOLUTION_SUCCESS
+  error?: string
+}
+
+const STAGES: Array<keyof Omit<RunTimings, "error">> = ["capture", "extraction", "firstCodeToken", "solution", "total"]
+
+const settings = {
+  providers: (option("provider", "all") === "all"
+    ? ["openai", "anthropic", "gemini"]
+    : option("provider", "all").split(",")) as ProviderId[],
+  iterations: Number(option("iterations", "20")),
+  warmup: Number(option("warmup", "2")),
+  screenshots: Number(option("screenshots", "2")),
+  fixtures: option("fixtures", path.join(__dirname, "..", "..", "bench", "fixtures")),
+  ttfbMs: Number(option("ttfb", "400")),
+  tokensPerSecond: Number(option("tokens-per-second", "150")),
+  failureRate: Number(option("failure-rate", "0")),
+  oneShot: flag("one-shot"),
+  stream: !flag("no-stream"),
+  json: option("json", ""),
+  verbose: flag("verbose")
+}
+
+function printSummary(provider: ProviderId, runs: RunTimings[]): void {
+  const summary = summarize(runs, STAGES)
+  const errors = runs.filter((run) => run.error).length
+  const format = (value: number) => (Number.isNaN(value) ? "-" : value.toFixed(0))
+
+  process.stdout.write(`\n${provider} (${runs.length} runs, ${errors} failed)\n`)
+  process.stdout.write(
+    `  ${"stage".padEnd(16)}${"n".padStart(5)}${"p50".padStart(8)}${"p95".padStart(8)}${"p99".padStart(8)}${"max".padStart(8)}  (ms)\n`
+  )
+  for (const stage of STAGES) {
+    const row = summary[stage]
+    process.stdout.write(
+      `  ${stage.padEnd(16)}${String(row.samples).padStart(5)}${format(row.p50).padStart(8)}${format(row.p95).padStart(8)}${format(row.p99).padStart(8)}${format(row.max).padStart(8)}\n`
+    )
+  }
+}
+
+async function main(): Promise<void> {
+  // Keep the benchmark's config, caches and screenshots out of the real profile
+  const userData = fs.mkdtempSync(path.join(os.tmpdir(), "interview-coder-bench-"))
+  app.setPath("userData", userData)
+  app.disableHardwareAcceleration()
+  await app.whenReady()
+
+  const fixtures = fs
+    .readdirSync(settings.fixtures)
+    .filter((file) => file.endsWith(".png"))
+    .sort()
+    .map((file) => fs.readFileSync(path.join(settings.fixtures, file)))
+  if (fixtures.length === 0) {
+    throw new Error(`No PNG fixtures found in ${settings.fixtures}`)
+  }
+
+  const server: MockProviderServer = await startMockProviderServer({
+    ttfbMs: settings.ttfbMs,
+    tokensPerSecond: settings.tokensPerSecond,
+    failureRate: settings.failureRate
+  })
+  process.env.OPENAI_BASE_URL = server.baseUrls.openai
+  process.env.ANTHROPIC_BASE_URL = server.baseUrls.anthropic
+  process.env.GEMINI_BASE_URL = server.baseUrls.gemini
+
+  // The app's logging would drown the report
+  const log = console.log
+  if (!settings.verbose) {
+    console.log = () => {}
+    console.warn = () => {}
+  }
+
+  // Loaded after userData is redirected, since these resolve paths on import
+  const { configHelper } = await import("../electron/ConfigHelper")
+  const { ScreenshotHelper } = await import("../electron/ScreenshotHelper")
+  const { ProcessingHelper } = await import("../electron/ProcessingHelper")
+
+  let view: "queue" | "solutions" | "debug" = "queue"
+  let problemInfo: any = null
+  let events: Array<{ channel: string; at: number; payload: any }> = []
+
+  const screenshotHelper = new ScreenshotHelper(view)
+  // Serve fixtures instead of capturing the desktop
+  let fixtureIndex = 0
+  ;(screenshotHelper as any).captureScreenshot = async () => fixtures[fixtureIndex++ % fixtures.length]
+
+  const fakeWindow = {
+    isDestroyed: () => false,
+    webContents: {
+      send: (channel: string, payload?: any) => events.push({ channel, at: performance.now(), payload }),
+      executeJavaScript: async () => true
+    }
+  } as any
+
+  const processingHelper = new ProcessingHelper({
+    getScreenshotHelper: () => screenshotHelper,
+    getMainWindow: () => fakeWindow,
+    getView: () => view,
+    setView: (next) => {
+      view = next
+      screenshotHelper.setView(next)
+    },
+    getProblemInfo: () => problemInfo,
+    setProblemInfo: (info) => (problemInfo = info),
+    getScreenshotQueue: () => screenshotHelper.getScreenshotQueue(),
+    getExtraScreenshotQueue: () => screenshotHelper.getExtraScreenshotQueue(),
+    clearQueues: () => screenshotHelper.clearQueues(),
+    takeScreenshot: () => screenshotHelper.takeScreenshot(async () => {}, () => {}),
+    getImagePreview: (filepath) => screenshotHelper.getImagePreview(filepath),
+    deleteScreenshot: (filepath) => screenshotHelper.deleteScreenshot(filepath),
+    setHasDebugged: () => {},
+    getHasDebugged: () => false,
+    PROCESSING_EVENTS
+  })
+
+  const results: Record<string, RunTimings[]> = {}
+
+  for (const provider of settings.providers) {
+    configHelper.updateConfig({
+      apiProvider: provider,
+      apiKey: `bench-${provider}-key`,
+      language: "python",
+      streamSolutions: settings.stream,
+      oneShotMode: settings.oneShot,
+      // Every run must reach the provider, and nothing should race it
+      extractionCacheEnabled: false,
+      historyEnabled: false,
+      speculativeExtraction: false,
+      hedgeEnabled: false,
+      // Fixtures repeat when --screenshots exceeds their count
+      duplicateScreenshots: "keep"
+    })
+
+    const runs: RunTimings[] = []
+    for (let iteration = 0; iteration < settings.warmup + settings.iterations; iteration++) {
+      view = "queue"
+      screenshotHelper.setView("queue")
+      screenshotHelper.clearQueues()
+      const captureStartedAt = performance.now()
+      for (let i = 0; i < settings.screenshots; i++) {
+        const screenshotPath = await screenshotHelper.takeScreenshot(async () => {}, () => {})
+        await screenshotHelper.getImagePreview(screenshotPath)
+      }
+      const captureMs = (performance.now() - captureStartedAt) / settings.screenshots
+
+      events = []
+      const startedAt = performance.now()
+      await processingHelper.processScreenshots()
+
+      const at = (channel: string, predicate: (payload: any) => boolean = () => true) =>
+        events.find((event) => event.channel === channel && predicate(event.payload))?.at
+      const extractedAt = at(PROCESSING_EVENTS.PROBLEM_EXTRACTED)
+      const firstCodeAt = at(PROCESSING_EVENTS.SOLUTION_CHUNK, (payload) => payload?.field === "code")
+      const successAt = at(PROCESSING_EVENTS.SOLUTION_SUCCESS)
+      const failure = events.find(
+        (event) =>
+          event.channel === PROCESSING_EVENTS.INITIAL_SOLUTION_ERROR ||
+          event.channel === PROCESSING_EVENTS.API_KEY_INVALID
+      )
+
+      const run: RunTimings = {
+        capture: captureMs,
+        extraction: extractedAt !== undefined ? extractedAt - startedAt : undefined,
+        firstCodeToken: firstCodeAt !== undefined ? firstCodeAt - startedAt : undefined,
+        solution: extractedAt !== undefined && successAt !== undefined ? successAt - extractedAt : undefined,
+        total: successAt !== undefined ? successAt - startedAt : undefined,
+        error: successAt === undefined ? String(failure?.payload ?? "no SOLUTION_SUCCESS") : undefined
+      }
+      if (iteration >= settings.warmup) runs.push(run)
+    }
+
+    results[provider] = runs
+    printSummary(provider, runs)
+  }
+
+  console.log = log
+  process.stdout.write(
+    `\nMock server: ${server.requests} requests, ${server.failures} injected failures\n`
+  )
+
+  if (settings.json) {
+    const report = {
+      settings,
+      results: Object.fromEntries(
+        Object.entries(results).map(([provider, runs]) => [provider, summarize(runs, STAGES)])
+      )
+    }
+    fs.writeFileSync(settings.json, JSON.stringify(report, null, 2))
+    process.stdout.write(`Wrote ${settings.json}\n`)
+  }
+
+  await server.close()
+  fs.rmSync(userData, { recursive: true, force: true })
+}
+
+main()
+  .then(() => app.exit(0))
+  .catch((error) => {
+    console.error("Pipeline benchmark failed:", error)
+    app.exit(1)
+  })
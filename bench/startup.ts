@@ -0,0 +1,160 @@
+// startup.ts
+// Cold-start benchmark. Launches the built app repeatedly against a throwaway
+// profile and reports how long each startup milestone takes from process
+// launch. The app reports its own marks and quits once housekeeping is done.
+//
+//   npm run bench:startup -- --iterations 10 --leftovers 20
+import { spawn } from "node:child_process"
+import fs from "node:fs"
+import os from "node:os"
+import path from "node:path"
+import { flag, option, summarize } from "./stats"
+
+// Resolves to the path of the Electron binary when required from Node
+const electronBinary: string = require("electron")
+
+interface StartupTimings {
+  appReady?: number             // Launch to app "ready"
+  windowCreated?: number        // Launch to the main window being created
+  firstPaint?: number           // Launch to the first frame painted after load
+  shortcutsRegistered?: number  // Launch to global shortcuts being live
+  housekeepingDone?: number     // Launch to leftover screenshots being cleaned up
+  error?: string
+}
+
+const MARKS: Array<keyof Omit<StartupTimings, "error">> = [
+  "appReady",
+  "windowCreated",
+  "firstPaint",
+  "shortcutsRegistered",
+  "housekeepingDone"
+]
+
+// Marker line printed by electron/main.ts in benchmark mode
+const TIMINGS_PREFIX = "STARTUP_TIMINGS "
+
+const settings = {
+  iterations: Number(option("iterations", "10")),
+  leftovers: Number(option("leftovers", "0")),
+  timeoutMs: Number(option("timeout", "30000")),
+  app: option("app", path.join(__dirname, "..", "..", "dist-electron", "main.js")),
+  json: option("json", ""),
+  verbose: flag("verbose")
+}
+
+function printSummary(label: string, runs: StartupTimings[]): void {
+  const summary = summarize(runs, MARKS)
+  const errors = runs.filter((run) => run.error).length
+  const format = (value: number) => (Number.isNaN(value) ? "-" : value.toFixed(0))
+
+  process.stdout.write(`\n${label} (${runs.length} runs, ${errors} failed)\n`)
+  process.stdout.write(
+    `  ${"milestone".padEnd(22)}${"n".padStart(5)}${"p50".padStart(8)}${"p95".padStart(8)}${"max".padStart(8)}  (ms)\n`
+  )
+  for (const mark of MARKS) {
+    const row = summary[mark]
+    process.stdout.write(
+      `  ${mark.padEnd(22)}${String(row.samples).padStart(5)}${format(row.p50).padStart(8)}${format(row.p95).padStart(8)}${format(row.max).padStart(8)}\n`
+    )
+  }
+}
+
+/**
+ * Fill the profile's screenshot folders with files for startup to clean up
+ */
+function seedLeftovers(userData: string, count: number): void {
+  // A real capture is a few hundred KB; the contents are never decoded
+  const payload = Buffer.alloc(256 * 1024)
+  for (const folder of ["screenshots", "extra_screenshots"]) {
+    const dir = path.join(userData, folder)
+    fs.mkdirSync(dir, { recursive: true })
+    for (let i = 0; i < count; i++) {
+      fs.writeFileSync(path.join(dir, `leftover-${i}.png`), payload)
+    }
+  }
+}
+
+/**
+ * Launch the app once and collect its startup marks, relative to the moment
+ * the process was spawned
+ */
+function launch(userData: string): Promise<StartupTimings> {
+  return new Promise((resolve) => {
+    const launchedAt = Date.now()
+    const child = spawn(electronBinary, [settings.app], {
+      env: {
+        ...process.env,
+        NODE_ENV: "production",
+        INTERVIEW_CODER_STARTUP_BENCH: "1",
+        INTERVIEW_CODER_APP_DATA: userData
+      },
+      stdio: ["ignore", "pipe", "pipe"]
+    })
+
+    let output = ""
+    let timings: StartupTimings | null = null
+    const timeout = setTimeout(() => {
+      child.kill()
+      resolve({ error: `no ${TIMINGS_PREFIX.trim()} within ${settings.timeoutMs} ms` })
+    }, settings.timeoutMs)
+
+    child.stdout.on("data", (chunk: Buffer) => {
+      output += chunk.toString()
+      if (settings.verbose) process.stdout.write(chunk)
+      const line = output.split("\n").find((candidate) => candidate.startsWith(TIMINGS_PREFIX))
+      if (!line || timings) return
+
+      // Marks are wall-clock times; the app's own processStart is left out
+      // because it misses the time spent before the runtime started
+      const marks: Record<string, number> = JSON.parse(line.slice(TIMINGS_PREFIX.length))
+      timings = Object.fromEntries(
+        MARKS.filter((mark) => marks[mark] !== undefined).map((mark) => [mark, marks[mark] - launchedAt])
+      )
+    })
+    if (settings.verbose) child.stderr.on("data", (chunk: Buffer) => process.stderr.write(chunk))
+
+    child.on("exit", (code) => {
+      clearTimeout(timeout)
+      resolve(timings ?? { error: `app exited with code ${code} before reporting` })
+    })
+  })
+}
+
+async function main(): Promise<void> {
+  if (!fs.existsSync(settings.app)) {
+    throw new Error(`${settings.app} not found; run npm run build first`)
+  }
+
+  // One profile for every run, so the first run is the cold one and later runs
+  // see the caches it left behind
+  const userData = fs.mkdtempSync(path.join(os.tmpdir(), "interview-coder-startup-"))
+  const runs: StartupTimings[] = []
+  try {
+    for (let iteration = 0; iteration < settings.iterations; iteration++) {
+      if (settings.leftovers > 0) seedLeftovers(userData, settings.leftovers)
+      const run = await launch(userData)
+      if (run.error) console.error(`Run ${iteration + 1} failed: ${run.error}`)
+      runs.push(run)
+    }
+  } finally {
+    fs.rmSync(userData, { recursive: true, force: true })
+  }
+
+  printSummary("cold (first launch)", runs.slice(0, 1))
+  if (runs.length > 1) printSummary("warm", runs.slice(1))
+
+  if (settings.json) {
+    const report = {
+      settings,
+      cold: summarize(runs.slice(0, 1), MARKS),
+      warm: summarize(runs.slice(1), MARKS)
+    }
+    fs.writeFileSync(settings.json, JSON.stringify(report, null, 2))
+    process.stdout.write(`Wrote ${settings.json}\n`)
+  }
+}
+
+main().catch((error) => {
+  console.error("Startup benchmark failed:", error)
+  process.exit(1)
+})
@@ -0,0 +1,61 @@
+// stats.ts
+// Command-line parsing and latency summaries shared by the benchmarks.
+
+const args = process.argv.slice(2)
+
+/**
+ * Value following --name on the command line, or the fallback
+ */
+export function option(name: string, fallback: string): string {
+  const index = args.indexOf(`--${name}`)
+  return index !== -1 && index + 1 < args.length ? args[index + 1] : fallback
+}
+
+export function flag(name: string): boolean {
+  return args.includes(`--${name}`)
+}
+
+export interface LatencySummary {
+  samples: number
+  p50: number
+  p95: number
+  p99: number
+  max: number
+}
+
+/**
+ * Nearest-rank percentile of an ascending list
+ */
+export function percentile(sorted: number[], p: number): number {
+  if (sorted.length === 0) return NaN
+  const rank = Math.ceil((p / 100) * sorted.length)
+  return sorted[Math.min(sorted.length - 1, Math.max(0, rank - 1))]
+}
+
+/**
+ * Percentiles of each named timing across runs. Runs missing a timing, such
+ * as failed ones, are left out of that timing's samples.
+ */
+export function summarize<K extends string>(
+  runs: Array<Partial<Record<K, unknown>>>,
+  keys: readonly K[]
+): Record<K, LatencySummary> {
+  return Object.fromEntries(
+    keys.map((key) => {
+      const values = runs
+        .map((run) => run[key])
+        .filter((value): value is number => typeof value === "number")
+        .sort((a, b) => a - b)
+      return [
+        key,
+        {
+          samples: values.length,
+          p50: percentile(values, 50),
+          p95: percentile(values, 95),
+          p99: percentile(values, 99),
+          max: values.length ? values[values.length - 1] : NaN
+        }
+      ]
+    })
+  ) as Record<K, LatencySummary>
+}
@@ -5,6 +5,19 @@ import { app } from "electron"
 import { EventEmitter } from "events"
 import { OpenAI } from "openai"
 
+// Capture rectangle in DIPs, relative to the top-left of its display
+export interface CaptureRegion {
+  displayId: number;
+  x: number;
+  y: number;
+  width: number;
+  height: number;
+}
+
+export type CaptureMode = "fullDesktop" | "cursorDisplay" | "region";
+
+export type DuplicateScreenshotAction = "replace" | "skip" | "keep";
+
 interface Config {
   apiKey: string;
   apiProvider: "openai" | "gemini" | "anthropic";  // Added provider selection
@@ -13,10 +26,56 @@ interface Config {
   debuggingModel: string;
   language: string;
   opacity: number;
+  streamSolutions: boolean;  // Push partial solution tokens to the renderer as they arrive
+  extractionCacheEnabled: boolean;  // Reuse problem extractions for recaptured screenshots
+  historyEnabled: boolean;  // Keep solved problems on disk and answer repeats from them
+  historyMaxMB: number;  // Size the history log is compacted down to once exceeded
+  speculativeExtraction: boolean;  // Start extraction in the background after each capture
+  oneShotMode: boolean;  // Extract the problem and solve it in a single request
+  imageOptimization: boolean;  // Downscale and re-encode screenshots before upload
+  imageFormat: "png" | "jpeg";  // Upload encoding when optimization is enabled
+  imageQuality: number;  // JPEG quality, 1-100
+  imageMaxDimension: number;  // Longest edge in pixels, 0 uses the provider's default
+  imageGrayscale: boolean;  // Drop color, useful for text-only problems
+  autoCrop: boolean;  // Crop screenshots to their text-heavy area before upload
+  cropOverlay: boolean;  // Outline the auto-crop area on screenshot previews
+  ocrEnabled: boolean;  // Read screenshots locally and send text instead of images when confident
+  ocrMinConfidence: number;  // Lowest Tesseract confidence (0-100) for which OCR text is trusted
+  hedgeEnabled: boolean;  // Race a second provider against the primary one
+  hedgeProvider: "openai" | "gemini" | "anthropic";  // Provider used for the hedge request
+  hedgeApiKey: string;  // API key for the hedge provider
+  hedgeDelayMs: number;  // Wait before starting the hedge request, 0 starts both at once
+  tracingEnabled: boolean;  // Record per-stage timing spans to a trace file
+  captureMode: CaptureMode;  // What a screenshot covers: every monitor, the one under the cursor, or a saved region
+  captureRegion: CaptureRegion | null;  // Last rectangle drawn with the region selector
+  duplicateScreenshots: DuplicateScreenshotAction;  // What to do with a capture of a screen already in the queue
+  duplicateHashDistance: number;  // Max differing bits (of 256) for two captures to count as the same screen
 }
 
+// Settings that require the AI clients to be re-initialized when they change
+const CLIENT_CONFIG_KEYS: Array<keyof Config> = [
+  "apiKey", "apiProvider", "extractionModel", "solutionModel", "debuggingModel",
+  "language", "hedgeEnabled", "hedgeProvider", "hedgeApiKey"
+];
+
 export class ConfigHelper extends EventEmitter {
   private configPath: string;
+  // Validated config as last read or written; replaced, never mutated
+  private snapshot: Readonly<Config> | null = null;
+  // Serialized snapshot, and the contents last written to disk, to tell our
+  // own writes from outside edits
+  private snapshotSource: string | null = null;
+  private writtenSource: string | null = null;
+  private watcher: fs.FSWatcher | null = null;
+  private reloadTimer: NodeJS.Timeout | null = null;
+  private readonly RELOAD_DELAY_MS = 100;
+  // Write-behind persistence: bursts of updates (such as holding an opacity
+  // shortcut) become one write, off the main thread
+  private persistTimer: NodeJS.Timeout | null = null;
+  private writeChain: Promise<void> = Promise.resolve();
+  private writesInFlight = 0;
+  private writeGeneration = 0;
+  private readonly PERSIST_DELAY_MS = 250;
   private defaultConfig: Config = {
     apiKey: "",
     apiProvider: "gemini", // Default to Gemini
@@ -24,7 +83,31 @@ export class ConfigHelper extends EventEmitter {
     solutionModel: "gemini-2.0-flash",
     debuggingModel: "gemini-2.0-flash",
     language: "python",
-    opacity: 1.0
+    opacity: 1.0,
+    streamSolutions: true,
+    extractionCacheEnabled: true,
+    historyEnabled: true,
+    historyMaxMB: 20,
+    speculativeExtraction: false,
+    oneShotMode: false,
+    imageOptimization: true,
+    imageFormat: "jpeg",
+    imageQuality: 85,
+    imageMaxDimension: 0,
+    imageGrayscale: false,
+    autoCrop: true,
+    cropOverlay: false,
+    ocrEnabled: false,
+    ocrMinConfidence: 85,
+    hedgeEnabled: false,
+    hedgeProvider: "openai",
+    hedgeApiKey: "",
+    hedgeDelayMs: 1500,
+    tracingEnabled: false,
+    captureMode: "fullDesktop",
+    captureRegion: null,
+    duplicateScreenshots: "replace",
+    duplicateHashDistance: 8
   };
 
   constructor() {
@@ -40,6 +123,105 @@ export class ConfigHelper extends EventEmitter {
     
     // Ensure the initial config file exists
     this.ensureConfigExists();
+    this.watchConfigFile();
+
+    // Don't lose an update still waiting to be written
+    try {
+      app.on('will-quit', () => this.flushSync());
+    } catch (err) {
+      console.warn('Could not register config flush on quit:', err);
+    }
+  }
+
+  /**
+   * Reload the snapshot when config.json is edited outside the app. The
+   * directory is watched rather than the file so replacing the file (as
+   * editors do when saving) does not end the watch.
+   */
+  private watchConfigFile(): void {
+    try {
+      const fileName = path.basename(this.configPath);
+      this.watcher = fs.watch(path.dirname(this.configPath), (_event, changed) => {
+        if (changed && changed.toString() !== fileName) return;
+        // Editors often write in several steps; reload once they settle
+        if (this.reloadTimer) clearTimeout(this.reloadTimer);
+        this.reloadTimer = setTimeout(() => {
+          this.reloadTimer = null;
+          this.reloadFromDisk();
+        }, this.RELOAD_DELAY_MS);
+      });
+      this.watcher.on('error', (err) => {
+        console.warn('Config file watch failed, outside edits will apply after restart:', err);
+        this.watcher?.close();
+        this.watcher = null;
+      });
+      // Never keep the process alive just for the watch
+      this.watcher.unref();
+    } catch (err) {
+      console.warn('Could not watch config file:', err);
+    }
+  }
+
+  private reloadFromDisk(): void {
+    let source: string;
+    try {
+      source = fs.readFileSync(this.configPath, 'utf8');
+    } catch (err: any) {
+      if (err?.code !== 'ENOENT') console.error('Error reading config:', err);
+      return;
+    }
+    // Our own writes, and files an in-progress save is about to replace
+    if (this.persistTimer || this.writesInFlight > 0) return;
+    if (source === this.snapshotSource || source === this.writtenSource) return;
+
+    let parsed: any;
+    try {
+      parsed = JSON.parse(source);
+    } catch (err) {
+      // Possibly a half-saved file; the next change event will try again
+      console.warn('Ignoring config.json change that is not valid JSON');
+      return;
+    }
+
+    const previous = this.snapshot;
+    this.setSnapshot(this.validateConfig(parsed), source);
+    this.writtenSource = source;
+    console.log('Reloaded config after an outside change');
+
+    const next = this.snapshot!;
+    if (!previous || CLIENT_CONFIG_KEYS.some((key) => previous[key] !== next[key])) {
+      this.emit('config-updated', next);
+    }
+  }
+
+  private setSnapshot(config: Config, source: string | null): void {
+    if (config.captureRegion) Object.freeze(config.captureRegion);
+    this.snapshot = Object.freeze(config);
+    this.snapshotSource = source;
+  }
+
+  /**
+   * Fill in defaults and correct invalid provider and model values
+   */
+  private validateConfig(stored: any): Config {
+    const config = { ...this.defaultConfig, ...stored };
+
+    // Ensure apiProvider is a valid value
+    if (config.apiProvider !== "openai" && config.apiProvider !== "gemini"  && config.apiProvider !== "anthropic") {
+      config.apiProvider = "gemini"; // Default to Gemini if invalid
+    }
+
+    // Sanitize model selections to ensure only allowed models are used
+    if (config.extractionModel) {
+      config.extractionModel = this.sanitizeModelSelection(config.extractionModel, config.apiProvider);
+    }
+    if (config.solutionModel) {
+      config.solutionModel = this.sanitizeModelSelection(config.solutionModel, config.apiProvider);
+    }
+    if (config.debuggingModel) {
+      config.debuggingModel = this.sanitizeModelSelection(config.debuggingModel, config.apiProvider);
+    }
+    return config;
   }
 
   /**
@@ -88,37 +270,25 @@ export class ConfigHelper extends EventEmitter {
     return model;
   }
 
-  public loadConfig(): Config {
+  /**
+   * Current config. Served from memory: the file is only read on first use
+   * and after it changes on disk, so this is cheap enough for hot paths. The
+   * result is frozen; change settings through updateConfig.
+   */
+  public getConfig(): Readonly<Config> {
+    if (this.snapshot) return this.snapshot;
+
     try {
       if (fs.existsSync(this.configPath)) {
-        const configData = fs.readFileSync(this.configPath, 'utf8');
-        const config = JSON.parse(configData);
-        
-        // Ensure apiProvider is a valid value
-        if (config.apiProvider !== "openai" && config.apiProvider !== "gemini"  && config.apiProvider !== "anthropic") {
-          config.apiProvider = "gemini"; // Default to Gemini if invalid
-        }
-        
-        // Sanitize model selections to ensure only allowed models are used
-        if (config.extractionModel) {
-          config.extractionModel = this.sanitizeModelSelection(config.extractionModel, config.apiProvider);
-        }
-        if (config.solutionModel) {
-          config.solutionModel = this.sanitizeModelSelection(config.solutionModel, config.apiProvider);
-        }
-        if (config.debuggingModel) {
-          config.debuggingModel = this.sanitizeModelSelection(config.debuggingModel, config.apiProvider);
-        }
-        
-        return {
-          ...this.defaultConfig,
-          ...config
-        };
+        const source = fs.readFileSync(this.configPath, 'utf8');
+        this.setSnapshot(this.validateConfig(JSON.parse(source)), source);
+        this.writtenSource = source;
+        return this.snapshot!;
       }
-      
+
       // If no config exists, create a default one
       this.saveConfig(this.defaultConfig);
-      return this.defaultConfig;
+      return this.snapshot ?? this.defaultConfig;
     } catch (err) {
       console.error("Error loading config:", err);
       return this.defaultConfig;
@@ -128,15 +298,78 @@ export class ConfigHelper extends EventEmitter {
   /**
    * Save configuration to disk
    */
-  public saveConfig(config: Config): void {
-    try {
-      // Ensure the directory exists
-      const configDir = path.dirname(this.configPath);
-      if (!fs.existsSync(configDir)) {
-        fs.mkdirSync(configDir, { recursive: true });
+  public saveConfig(config: Readonly<Config>): void {
+    // The snapshot changes right away, so readers and config-updated listeners
+    // never wait on the disk; the file follows shortly after
+    this.setSnapshot({ ...config }, JSON.stringify(config, null, 2));
+    if (!this.persistTimer) {
+      this.persistTimer = setTimeout(() => {
+        this.persistTimer = null;
+        void this.persist();
+      }, this.PERSIST_DELAY_MS);
+    }
+  }
+
+  /**
+   * Write the current snapshot to a temporary file and rename it over
+   * config.json, so the file is never seen half written
+   */
+  private persist(): Promise<void> {
+    const source = this.snapshotSource;
+    if (source === null || source === this.writtenSource) return this.writeChain;
+
+    const generation = ++this.writeGeneration;
+    this.writesInFlight++;
+    this.writeChain = this.writeChain.then(async () => {
+      const tempPath = `${this.configPath}.${generation}.tmp`;
+      try {
+        await fs.promises.mkdir(path.dirname(this.configPath), { recursive: true });
+        await fs.promises.writeFile(tempPath, source);
+        // A synchronous flush at quit may have written newer settings meanwhile
+        if (generation !== this.writeGeneration) {
+          await fs.promises.unlink(tempPath).catch(() => {});
+          return;
+        }
+        await this.replaceConfigFile(tempPath, source);
+        this.writtenSource = source;
+      } catch (err) {
+        console.error("Error saving config:", err);
+      } finally {
+        this.writesInFlight--;
       }
-      // Write the config file
-      fs.writeFileSync(this.configPath, JSON.stringify(config, null, 2));
+    });
+    return this.writeChain;
+  }
+
+  private async replaceConfigFile(tempPath: string, source: string): Promise<void> {
+    try {
+      await fs.promises.rename(tempPath, this.configPath);
+    } catch (err: any) {
+      // Windows refuses the rename while another process has the file open
+      if (err?.code !== 'EPERM' && err?.code !== 'EBUSY') throw err;
+      await fs.promises.writeFile(this.configPath, source);
+      await fs.promises.unlink(tempPath).catch(() => {});
+    }
+  }
+
+  /**
+   * Write any pending change immediately. Only for shutdown, when the event
+   * loop may not get to the write-behind.
+   */
+  public flushSync(): void {
+    if (this.persistTimer) {
+      clearTimeout(this.persistTimer);
+      this.persistTimer = null;
+    }
+    const source = this.snapshotSource;
+    if (source === null || source === this.writtenSource) return;
+
+    const tempPath = `${this.configPath}.${++this.writeGeneration}.tmp`;
+    try {
+      fs.mkdirSync(path.dirname(this.configPath), { recursive: true });
+      fs.writeFileSync(tempPath, source);
+      fs.renameSync(tempPath, this.configPath);
+      this.writtenSource = source;
     } catch (err) {
       console.error("Error saving config:", err);
     }
@@ -145,9 +378,9 @@ export class ConfigHelper extends EventEmitter {
   /**
    * Update specific configuration values
    */
-  public updateConfig(updates: Partial<Config>): Config {
+  public updateConfig(updates: Partial<Config>): Readonly<Config> {
     try {
-      const currentConfig = this.loadConfig();
+      const currentConfig = this.getConfig();
       let provider = updates.apiProvider || currentConfig.apiProvider;
       
       // Auto-detect provider based on API key format if a new key is provided
@@ -196,14 +429,12 @@ export class ConfigHelper extends EventEmitter {
         updates.debuggingModel = this.sanitizeModelSelection(updates.debuggingModel, provider);
       }
       
-      const newConfig = { ...currentConfig, ...updates };
-      this.saveConfig(newConfig);
+      this.saveConfig({ ...currentConfig, ...updates });
+      const newConfig = this.getConfig();
       
       // Only emit update event for changes other than opacity
       // This prevents re-initializing the AI client when only opacity changes
-      if (updates.apiKey !== undefined || updates.apiProvider !== undefined || 
-          updates.extractionModel !== undefined || updates.solutionModel !== undefined || 
-          updates.debuggingModel !== undefined || updates.language !== undefined) {
+      if (CLIENT_CONFIG_KEYS.some((key) => updates[key] !== undefined)) {
         this.emit('config-updated', newConfig);
       }
       
@@ -218,7 +449,7 @@ export class ConfigHelper extends EventEmitter {
    * Check if the API key is configured
    */
   public hasApiKey(): boolean {
-    const config = this.loadConfig();
+    const config = this.getConfig();
     return !!config.apiKey && config.apiKey.trim().length > 0;
   }
   
@@ -257,7 +488,7 @@ export class ConfigHelper extends EventEmitter {
    * Get the stored opacity value
    */
   public getOpacity(): number {
-    const config = this.loadConfig();
+    const config = this.getConfig();
     return config.opacity !== undefined ? config.opacity : 1.0;
   }
 
@@ -274,7 +505,7 @@ export class ConfigHelper extends EventEmitter {
    * Get the preferred programming language
    */
   public getLanguage(): string {
-    const config = this.loadConfig();
+    const config = this.getConfig();
     return config.language || "python";
   }
 
@@ -0,0 +1,174 @@
+// ContentCropper.ts
+import { Bitmap } from "./bitmap"
+
+// Bounding box of the text-heavy part of a screenshot, in source pixels
+export interface ContentCrop {
+  x: number
+  y: number
+  width: number
+  height: number
+  sourceWidth: number
+  sourceHeight: number
+}
+
+// The same box as fractions of the source, for drawing over previews
+export interface RelativeCrop {
+  x: number
+  y: number
+  width: number
+  height: number
+  aspect: number            // Source width / height
+}
+
+// Width the detector works at; text strokes still produce edges at this scale
+export const CONTENT_ANALYSIS_WIDTH = 480
+// Side of the square cells edge density is measured over, in analysis pixels
+const CELL_SIZE = 8
+// Brightness step between neighbouring pixels that counts as an edge (0-765)
+const EDGE_THRESHOLD = 90
+// Share of edge pixels that makes a cell look like text
+const TEXT_CELL_DENSITY = 0.06
+// Fewer text cells than this and the detector does not trust itself
+const MIN_TEXT_CELLS = 12
+// Text clusters smaller than this share of the largest are treated as noise
+const MIN_CLUSTER_SHARE = 0.2
+// Cells of margin kept around the detected area
+const PADDING_CELLS = 1
+// A crop that keeps more of the image than this is not worth re-encoding for
+const MAX_KEPT_AREA = 0.9
+
+/**
+ * Mark the cells of a downsampled image whose edge density looks like text.
+ * Brightness is an unweighted sum of the colour channels.
+ */
+function findTextCells(image: Bitmap): { cells: Uint8Array; columns: number; rows: number } {
+  const { width, height, data: bitmap } = image
+  const columns = Math.ceil(width / CELL_SIZE)
+  const rows = Math.ceil(height / CELL_SIZE)
+  const edgeCounts = new Uint32Array(columns * rows)
+
+  const brightness = (x: number, y: number): number => {
+    const offset = (y * width + x) * 4
+    return bitmap[offset] + bitmap[offset + 1] + bitmap[offset + 2]
+  }
+
+  for (let y = 0; y < height - 1; y++) {
+    for (let x = 0; x < width - 1; x++) {
+      const value = brightness(x, y)
+      if (
+        Math.abs(value - brightness(x + 1, y)) > EDGE_THRESHOLD ||
+        Math.abs(value - brightness(x, y + 1)) > EDGE_THRESHOLD
+      ) {
+        edgeCounts[Math.floor(y / CELL_SIZE) * columns + Math.floor(x / CELL_SIZE)]++
+      }
+    }
+  }
+
+  const cells = new Uint8Array(columns * rows)
+  for (let row = 0; row < rows; row++) {
+    for (let column = 0; column < columns; column++) {
+      // Edge cells are clipped by the image border
+      const cellWidth = Math.min(CELL_SIZE, width - column * CELL_SIZE)
+      const cellHeight = Math.min(CELL_SIZE, height - row * CELL_SIZE)
+      const index = row * columns + column
+      cells[index] = edgeCounts[index] >= TEXT_CELL_DENSITY * cellWidth * cellHeight ? 1 : 0
+    }
+  }
+  return { cells, columns, rows }
+}
+
+/**
+ * Find the bounding box of the text-heavy area of a screenshot. Text cells are
+ * grouped into clusters, bridging one-cell gaps between words and lines, and
+ * the box covers every cluster of a meaningful size, so a problem statement and
+ * an editor side by side both stay in. The analysis image is the source
+ * downscaled to at most CONTENT_ANALYSIS_WIDTH wide. Returns null when nothing
+ * worth cropping was found.
+ */
+export function detectContentRegion(
+  analysis: Bitmap,
+  source: { width: number; height: number }
+): ContentCrop | null {
+  if (source.width === 0 || source.height === 0 || analysis.width === 0) return null
+
+  const { cells, columns, rows } = findTextCells(analysis)
+
+  let textCells = 0
+  for (const cell of cells) textCells += cell
+  if (textCells < MIN_TEXT_CELLS) return null
+
+  // Label clusters over the text cells grown by one cell in every direction
+  const labels = new Int32Array(columns * rows).fill(-1)
+  const isGrown = (column: number, row: number): boolean => {
+    for (let dy = -1; dy <= 1; dy++) {
+      for (let dx = -1; dx <= 1; dx++) {
+        const c = column + dx
+        const r = row + dy
+        if (c >= 0 && c < columns && r >= 0 && r < rows && cells[r * columns + c]) return true
+      }
+    }
+    return false
+  }
+
+  const clusters: Array<{ weight: number; left: number; top: number; right: number; bottom: number }> = []
+  const stack: number[] = []
+  for (let start = 0; start < cells.length; start++) {
+    if (!cells[start] || labels[start] !== -1) continue
+
+    const cluster = { weight: 0, left: columns, top: rows, right: -1, bottom: -1 }
+    labels[start] = clusters.length
+    stack.push(start)
+    while (stack.length > 0) {
+      const index = stack.pop()!
+      const column = index % columns
+      const row = Math.floor(index / columns)
+      if (cells[index]) {
+        cluster.weight++
+        cluster.left = Math.min(cluster.left, column)
+        cluster.top = Math.min(cluster.top, row)
+        cluster.right = Math.max(cluster.right, column)
+        cluster.bottom = Math.max(cluster.bottom, row)
+      }
+      for (const [dx, dy] of [[1, 0], [-1, 0], [0, 1], [0, -1]]) {
+        const c = column + dx
+        const r = row + dy
+        if (c < 0 || c >= columns || r < 0 || r >= rows) continue
+        const next = r * columns + c
+        if (labels[next] === -1 && isGrown(c, r)) {
+          labels[next] = clusters.length
+          stack.push(next)
+        }
+      }
+    }
+    clusters.push(cluster)
+  }
+
+  const largest = Math.max(...clusters.map((cluster) => cluster.weight))
+  const kept = clusters.filter((cluster) => cluster.weight >= largest * MIN_CLUSTER_SHARE)
+  const left = Math.max(0, Math.min(...kept.map((cluster) => cluster.left)) - PADDING_CELLS)
+  const top = Math.max(0, Math.min(...kept.map((cluster) => cluster.top)) - PADDING_CELLS)
+  const right = Math.min(columns - 1, Math.max(...kept.map((cluster) => cluster.right)) + PADDING_CELLS)
+  const bottom = Math.min(rows - 1, Math.max(...kept.map((cluster) => cluster.bottom)) + PADDING_CELLS)
+
+  // Map cell bounds back to source pixels
+  const scale = source.width / analysis.width
+  const x = Math.floor(left * CELL_SIZE * scale)
+  const y = Math.floor(top * CELL_SIZE * scale)
+  const width = Math.min(source.width, Math.ceil((right + 1) * CELL_SIZE * scale)) - x
+  const height = Math.min(source.height, Math.ceil((bottom + 1) * CELL_SIZE * scale)) - y
+
+  if (width <= 0 || height <= 0) return null
+  if (width * height > MAX_KEPT_AREA * source.width * source.height) return null
+
+  return { x, y, width, height, sourceWidth: source.width, sourceHeight: source.height }
+}
+
+export function toRelativeCrop(crop: ContentCrop): RelativeCrop {
+  return {
+    x: crop.x / crop.sourceWidth,
+    y: crop.y / crop.sourceHeight,
+    width: crop.width / crop.sourceWidth,
+    height: crop.height / crop.sourceHeight,
+    aspect: crop.sourceWidth / crop.sourceHeight
+  }
+}
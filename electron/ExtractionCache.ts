@@ -0,0 +1,168 @@
+// ExtractionCache.ts
+import fs from "node:fs"
+import path from "node:path"
+import { app } from "electron"
+import { hammingDistance } from "./imageHash"
+
+interface ExtractionCacheEntry {
+  extractor: string;    // Provider and model that extracted the problem
+  hashes: string[];     // 256-bit perceptual hash of each screenshot, in queue order
+  problemInfo: any;     // Parsed extraction result
+  createdAt: number;
+  lastUsedAt: number;
+}
+
+interface ExtractionCacheFile {
+  version: number;
+  entries: ExtractionCacheEntry[];
+}
+
+export interface ExtractionCacheStats {
+  hits: number;
+  misses: number;
+  entries: number;
+}
+
+/**
+ * Persistent map from the perceptual hashes of an ordered screenshot set to
+ * the problem info extracted from it, so recapturing the same problem skips
+ * the vision round-trip. Entries are also keyed by the extracting provider and
+ * model, so switching models does not keep serving the old model's output.
+ */
+export class ExtractionCache {
+  // Bumped when hashing or keying changes; older entries do not compare
+  private static readonly VERSION = 4;
+  private readonly MAX_ENTRIES = 50;
+  // Maximum per-screenshot Hamming distance (of 256 bits) still treated as the
+  // same image. Stricter than repeat-capture detection, since a false match
+  // here serves another problem's extraction.
+  private readonly MAX_HASH_DISTANCE = 4;
+
+  private cachePath: string | null = null;
+  private entries: ExtractionCacheEntry[] | null = null;
+  private loadPromise: Promise<void> | null = null;
+  private writeChain: Promise<void> = Promise.resolve();
+  private hits = 0;
+  private misses = 0;
+
+  /**
+   * Resolve the cache path lazily so it follows any userData override made
+   * during app initialization
+   */
+  private getCachePath(): string {
+    if (!this.cachePath) {
+      try {
+        this.cachePath = path.join(app.getPath('userData'), 'extraction-cache.json');
+      } catch (err) {
+        console.warn('Could not access user data path for extraction cache, using fallback');
+        this.cachePath = path.join(process.cwd(), 'extraction-cache.json');
+      }
+    }
+    return this.cachePath;
+  }
+
+  private async ensureLoaded(): Promise<void> {
+    if (this.entries) return;
+    if (!this.loadPromise) {
+      this.loadPromise = (async () => {
+        try {
+          const raw = await fs.promises.readFile(this.getCachePath(), 'utf8');
+          const parsed = JSON.parse(raw) as ExtractionCacheFile;
+          this.entries = parsed.version === ExtractionCache.VERSION && Array.isArray(parsed.entries)
+            ? parsed.entries
+            : [];
+        } catch (err: any) {
+          if (err?.code !== 'ENOENT') {
+            console.warn("Error loading extraction cache, starting empty:", err);
+          }
+          this.entries = [];
+        }
+      })();
+    }
+    await this.loadPromise;
+  }
+
+  /**
+   * Write the cache to disk, serializing writes so they never interleave.
+   * The file is replaced atomically, so a crash mid-write keeps the old cache.
+   */
+  private persist(): Promise<void> {
+    this.writeChain = this.writeChain.then(async () => {
+      try {
+        const data: ExtractionCacheFile = {
+          version: ExtractionCache.VERSION,
+          entries: this.entries || []
+        };
+        const tempPath = `${this.getCachePath()}.tmp`;
+        await fs.promises.writeFile(tempPath, JSON.stringify(data));
+        await fs.promises.rename(tempPath, this.getCachePath());
+      } catch (err) {
+        console.error("Error saving extraction cache:", err);
+      }
+    });
+    return this.writeChain;
+  }
+
+  private matches(entry: ExtractionCacheEntry, extractor: string, hashes: string[]): boolean {
+    if (entry.extractor !== extractor || entry.hashes.length !== hashes.length) return false;
+    return entry.hashes.every(
+      (hash, index) => hammingDistance(hash, hashes[index]) <= this.MAX_HASH_DISTANCE
+    );
+  }
+
+  /**
+   * Look up problem info the given extractor produced for a screenshot set.
+   * Updates the hit/miss counters.
+   */
+  public async lookup(extractor: string, hashes: string[]): Promise<any | null> {
+    await this.ensureLoaded();
+
+    const entry = this.entries.find((candidate) => this.matches(candidate, extractor, hashes));
+    if (!entry) {
+      this.misses++;
+      console.log(`Extraction cache miss (hits: ${this.hits}, misses: ${this.misses})`);
+      return null;
+    }
+
+    this.hits++;
+    entry.lastUsedAt = Date.now();
+    console.log(`Extraction cache hit (hits: ${this.hits}, misses: ${this.misses})`);
+    void this.persist();
+    return entry.problemInfo;
+  }
+
+  /**
+   * Remember the problem info an extractor produced for a screenshot set
+   */
+  public async store(extractor: string, hashes: string[], problemInfo: any): Promise<void> {
+    await this.ensureLoaded();
+
+    const now = Date.now();
+    this.entries = this.entries.filter((candidate) => !this.matches(candidate, extractor, hashes));
+    this.entries.push({ extractor, hashes, problemInfo, createdAt: now, lastUsedAt: now });
+
+    // Evict least recently used entries beyond the limit
+    if (this.entries.length > this.MAX_ENTRIES) {
+      this.entries.sort((a, b) => b.lastUsedAt - a.lastUsedAt);
+      this.entries = this.entries.slice(0, this.MAX_ENTRIES);
+    }
+
+    await this.persist();
+  }
+
+  public getStats(): ExtractionCacheStats {
+    return {
+      hits: this.hits,
+      misses: this.misses,
+      entries: this.entries ? this.entries.length : 0
+    };
+  }
+
+  public async clear(): Promise<void> {
+    this.entries = [];
+    await this.persist();
+  }
+}
+
+// Export a singleton instance
+export const extractionCache = new ExtractionCache();
@@ -0,0 +1,515 @@
+// HistoryStore.ts
+import fs from "node:fs"
+import path from "node:path"
+import crypto from "node:crypto"
+import { app } from "electron"
+import { configHelper } from "./ConfigHelper"
+import { hammingDistance } from "./imageHash"
+
+type HistoryRecordType = "extraction" | "solution" | "debug";
+
+// One line of the log
+interface HistoryRecord {
+  type: HistoryRecordType;
+  problemKey: string;
+  hashes: string[];       // 256-bit hashes of the screenshots the result came from, in queue order
+  extractor?: string;     // Extractions only: provider and model that read the screenshots
+  language?: string;      // Solutions and debug results only
+  createdAt: number;
+  data: any;
+}
+
+// Where a record's JSON sits in the log, excluding its newline
+interface RecordRef {
+  offset: number;
+  length: number;
+}
+
+// Screenshots a problem was extracted from, and by which provider and model.
+// Keyed like ExtractionCache, so a screenshot set only recalls what the
+// current extractor would have read from it.
+interface HashSet {
+  extractor: string;
+  hashes: string[];
+}
+
+interface HistoryEntry {
+  problemKey: string;
+  hashSets: HashSet[];
+  extraction: RecordRef;
+  solutions: Record<string, RecordRef>;   // By language
+  debugs: Array<{ hashes: string[]; language: string; ref: RecordRef }>;
+  lastUsedAt: number;
+}
+
+interface HistoryIndexFile {
+  version: number;
+  logBytes: number;       // Log size the index was written for
+  entries: HistoryEntry[];
+}
+
+export interface HistoryStats {
+  problems: number;
+  bytes: number;
+  hits: number;
+  misses: number;
+}
+
+/**
+ * Collapse formatting differences so the same problem read from different
+ * screenshots, or by a different model, maps to the same key
+ */
+export function normalizeProblemStatement(statement: unknown): string {
+  if (typeof statement !== "string") return "";
+  return statement
+    .normalize("NFKC")
+    .toLowerCase()
+    .replace(/[^\p{L}\p{N}]+/gu, " ")
+    .trim();
+}
+
+function problemKeyOf(problemInfo: any): string | null {
+  const normalized = normalizeProblemStatement(problemInfo?.problem_statement);
+  if (!normalized) return null;
+  return crypto.createHash("sha1").update(normalized).digest("hex");
+}
+
+/**
+ * Every problem solved on this machine, with its extraction, solutions and
+ * debug results, so a problem seen before is answered from disk instead of a
+ * model call. Records are appended to a JSON-lines log; an index keyed by
+ * normalized problem statement, and by screenshot hash per extractor, points
+ * into it and is kept in memory. The log is the source of truth: a missing or stale index is
+ * rebuilt from it, and compaction rewrites it to the most recently used
+ * problems once it outgrows its size budget.
+ */
+export class HistoryStore {
+  private static readonly VERSION = 2;
+  // Maximum per-screenshot Hamming distance (of 256 bits) still treated as the
+  // same image. A match serves a stored solution with no model call, so this
+  // only forgives capture noise, not a different problem in the same layout.
+  private readonly MAX_HASH_DISTANCE = 4;
+  private readonly MAX_HASH_SETS = 5;
+  private readonly MAX_DEBUGS = 10;
+  private readonly INDEX_WRITE_DELAY_MS = 1000;
+  // Compaction also runs once this share of the log is superseded records
+  private readonly MAX_DEAD_SHARE = 0.5;
+  private readonly MIN_COMPACT_BYTES = 1024 * 1024;
+
+  private dir: string | null = null;
+  private entries: Map<string, HistoryEntry> | null = null;
+  private loadPromise: Promise<void> | null = null;
+  // Log reads, appends and rewrites run one at a time, so a read never sees
+  // a half-written record or a log that was replaced under its offsets
+  private queue: Promise<unknown> = Promise.resolve();
+  private logBytes = 0;
+  private indexTimer: NodeJS.Timeout | null = null;
+  private hits = 0;
+  private misses = 0;
+
+  /**
+   * Resolve the history folder lazily so it follows any userData override
+   * made during app initialization
+   */
+  private getDir(): string {
+    if (!this.dir) {
+      try {
+        this.dir = path.join(app.getPath('userData'), 'history');
+      } catch (err) {
+        console.warn('Could not access user data path for history, using fallback');
+        this.dir = path.join(process.cwd(), 'history');
+      }
+    }
+    return this.dir;
+  }
+
+  private get logPath(): string {
+    return path.join(this.getDir(), 'history.log');
+  }
+
+  private get indexPath(): string {
+    return path.join(this.getDir(), 'history-index.json');
+  }
+
+  private enqueue<T>(task: () => Promise<T>): Promise<T> {
+    const run = this.queue.then(task);
+    this.queue = run.catch(() => {});
+    return run;
+  }
+
+  private async ensureLoaded(): Promise<void> {
+    if (this.entries) return;
+    if (!this.loadPromise) {
+      this.loadPromise = this.enqueue(async () => {
+        await fs.promises.mkdir(this.getDir(), { recursive: true });
+        const logBytes = await fs.promises.stat(this.logPath).then((stat) => stat.size, () => 0);
+
+        try {
+          const index = JSON.parse(await fs.promises.readFile(this.indexPath, 'utf8')) as HistoryIndexFile;
+          if (index.version === HistoryStore.VERSION && index.logBytes === logBytes && Array.isArray(index.entries)) {
+            this.entries = new Map(index.entries.map((entry) => [entry.problemKey, entry]));
+            this.logBytes = logBytes;
+            return;
+          }
+          console.log("History index is stale, rebuilding from the log");
+        } catch (err: any) {
+          if (err?.code !== 'ENOENT') {
+            console.warn("Error loading history index, rebuilding from the log:", err);
+          }
+        }
+        await this.rebuildIndex();
+      });
+    }
+    await this.loadPromise;
+  }
+
+  /**
+   * Recreate the index by scanning the log. A record cut short by a crash is
+   * dropped so later appends start on a fresh line.
+   */
+  private async rebuildIndex(): Promise<void> {
+    this.entries = new Map();
+    this.logBytes = 0;
+
+    let log: Buffer;
+    try {
+      log = await fs.promises.readFile(this.logPath);
+    } catch (err: any) {
+      if (err?.code !== 'ENOENT') console.warn("Error reading history log, starting empty:", err);
+      return;
+    }
+
+    let offset = 0;
+    while (offset < log.length) {
+      const end = log.indexOf(0x0a, offset);
+      if (end === -1) break;
+      try {
+        const record = JSON.parse(log.toString('utf8', offset, end)) as HistoryRecord;
+        this.applyRecord(record, { offset, length: end - offset });
+      } catch (err) {
+        console.warn(`Skipping unreadable history record at byte ${offset}`);
+      }
+      offset = end + 1;
+    }
+
+    this.logBytes = offset;
+    if (offset < log.length) {
+      await fs.promises.truncate(this.logPath, offset);
+    }
+    console.log(`Rebuilt history index: ${this.entries.size} problems`);
+    this.scheduleIndexWrite();
+  }
+
+  /**
+   * Point the index at a record appended to (or found in) the log
+   */
+  private applyRecord(record: HistoryRecord, ref: RecordRef): void {
+    let entry = this.entries.get(record.problemKey);
+    if (record.type === "extraction") {
+      if (!entry) {
+        entry = {
+          problemKey: record.problemKey,
+          hashSets: [],
+          extraction: ref,
+          solutions: {},
+          debugs: [],
+          lastUsedAt: record.createdAt
+        };
+        this.entries.set(record.problemKey, entry);
+      }
+      entry.extraction = ref;
+      // Records written before extractions carried their extractor still
+      // supply the problem, but not a screenshot match
+      const extractor = record.extractor;
+      if (extractor && record.hashes.length > 0 && !this.hasHashSet(entry, extractor, record.hashes)) {
+        entry.hashSets = [...entry.hashSets, { extractor, hashes: record.hashes }].slice(-this.MAX_HASH_SETS);
+      }
+    } else if (!entry) {
+      // Results are only kept for problems whose extraction is known
+      return;
+    } else if (record.type === "solution") {
+      entry.solutions[record.language || "python"] = ref;
+    } else {
+      const language = record.language || "python";
+      entry.debugs = [
+        ...entry.debugs.filter((debug) => debug.language !== language || !this.matches(debug.hashes, record.hashes)),
+        { hashes: record.hashes, language, ref }
+      ].slice(-this.MAX_DEBUGS);
+    }
+    entry.lastUsedAt = Math.max(entry.lastUsedAt, record.createdAt);
+  }
+
+  private matches(a: string[], b: string[]): boolean {
+    if (a.length !== b.length) return false;
+    return a.every((hash, index) => hammingDistance(hash, b[index]) <= this.MAX_HASH_DISTANCE);
+  }
+
+  private hasHashSet(entry: HistoryEntry, extractor: string, hashes: string[]): boolean {
+    return entry.hashSets.some((set) => set.extractor === extractor && this.matches(set.hashes, hashes));
+  }
+
+  private append(record: HistoryRecord): Promise<void> {
+    return this.enqueue(async () => {
+      const line = JSON.stringify(record);
+      const length = Buffer.byteLength(line);
+      await fs.promises.appendFile(this.logPath, line + "\n");
+      this.applyRecord(record, { offset: this.logBytes, length });
+      this.logBytes += length + 1;
+    })
+      .then(() => this.compactIfNeeded())
+      .then(() => this.scheduleIndexWrite())
+      .catch((err) => console.error("Error writing to history:", err));
+  }
+
+  private async readRecord(entry: HistoryEntry, ref: RecordRef): Promise<any | null> {
+    return this.enqueue(async () => {
+      const handle = await fs.promises.open(this.logPath, 'r');
+      try {
+        const buffer = Buffer.alloc(ref.length);
+        await handle.read(buffer, 0, ref.length, ref.offset);
+        const record = JSON.parse(buffer.toString('utf8')) as HistoryRecord;
+        // An index that disagrees with the log is worth a miss, not a wrong answer
+        return record.problemKey === entry.problemKey ? record.data : null;
+      } finally {
+        await handle.close();
+      }
+    }).catch((err) => {
+      console.warn("Error reading history record:", err);
+      return null;
+    });
+  }
+
+  private scheduleIndexWrite(): void {
+    if (this.indexTimer) return;
+    this.indexTimer = setTimeout(() => {
+      this.indexTimer = null;
+      void this.enqueue(() => this.writeIndex()).catch((err) => {
+        console.error("Error saving history index:", err);
+      });
+    }, this.INDEX_WRITE_DELAY_MS);
+  }
+
+  private async writeIndex(): Promise<void> {
+    const data: HistoryIndexFile = {
+      version: HistoryStore.VERSION,
+      logBytes: this.logBytes,
+      entries: [...(this.entries?.values() ?? [])]
+    };
+    const tempPath = `${this.indexPath}.tmp`;
+    await fs.promises.writeFile(tempPath, JSON.stringify(data));
+    await fs.promises.rename(tempPath, this.indexPath);
+  }
+
+  private liveRefs(entry: HistoryEntry): RecordRef[] {
+    return [entry.extraction, ...Object.values(entry.solutions), ...entry.debugs.map((debug) => debug.ref)];
+  }
+
+  private getMaxBytes(): number {
+    return Math.max(1, configHelper.getConfig().historyMaxMB) * 1024 * 1024;
+  }
+
+  /**
+   * Rewrite the log without superseded records once it exceeds its budget or
+   * is mostly dead space. Over budget, the most recently used problems are
+   * kept up to half of it, so compaction does not run again on the next few
+   * appends.
+   */
+  private compactIfNeeded(): Promise<void> {
+    return this.enqueue(async () => {
+      const maxBytes = this.getMaxBytes();
+      let liveBytes = 0;
+      for (const entry of this.entries.values()) {
+        for (const ref of this.liveRefs(entry)) liveBytes += ref.length + 1;
+      }
+      const deadBytes = this.logBytes - liveBytes;
+      if (
+        this.logBytes <= maxBytes &&
+        (this.logBytes < this.MIN_COMPACT_BYTES || deadBytes < this.logBytes * this.MAX_DEAD_SHARE)
+      ) {
+        return;
+      }
+
+      const startedAt = Date.now();
+      const previousBytes = this.logBytes;
+      const log = await fs.promises.readFile(this.logPath);
+      const budget = this.logBytes > maxBytes ? maxBytes / 2 : maxBytes;
+
+      const kept: HistoryEntry[] = [];
+      let keptBytes = 0;
+      const byRecency = [...this.entries.values()].sort((a, b) => b.lastUsedAt - a.lastUsedAt);
+      for (const entry of byRecency) {
+        const size = this.liveRefs(entry).reduce((total, ref) => total + ref.length + 1, 0);
+        if (kept.length > 0 && keptBytes + size > budget) break;
+        kept.push(entry);
+        keptBytes += size;
+      }
+
+      // Copy each kept record and point the index at its new place
+      const chunks: Buffer[] = [];
+      let offset = 0;
+      const move = (ref: RecordRef): RecordRef => {
+        chunks.push(log.subarray(ref.offset, ref.offset + ref.length), Buffer.from("\n"));
+        const moved = { offset, length: ref.length };
+        offset += ref.length + 1;
+        return moved;
+      };
+      const entries = new Map<string, HistoryEntry>();
+      for (const entry of kept) {
+        entries.set(entry.problemKey, {
+          ...entry,
+          extraction: move(entry.extraction),
+          solutions: Object.fromEntries(
+            Object.entries(entry.solutions).map(([language, ref]) => [language, move(ref)])
+          ),
+          debugs: entry.debugs.map((debug) => ({ ...debug, ref: move(debug.ref) }))
+        });
+      }
+
+      const tempPath = `${this.logPath}.tmp`;
+      await fs.promises.writeFile(tempPath, Buffer.concat(chunks));
+      await fs.promises.rename(tempPath, this.logPath);
+      this.entries = entries;
+      this.logBytes = offset;
+      await this.writeIndex();
+      console.log(
+        `Compacted history from ${previousBytes} to ${offset} bytes ` +
+        `(${kept.length} problems kept) in ${Date.now() - startedAt} ms`
+      );
+    });
+  }
+
+  /**
+   * Find a problem the same extractor read earlier from the same screenshots,
+   * with the solution in the given language if there is one
+   */
+  public async recallByScreenshots(
+    extractor: string,
+    hashes: string[],
+    language: string
+  ): Promise<{ problemInfo: any; solution: any | null } | null> {
+    await this.ensureLoaded();
+
+    const entry = [...this.entries.values()].find((candidate) => this.hasHashSet(candidate, extractor, hashes));
+    if (!entry) {
+      this.misses++;
+      return null;
+    }
+
+    const problemInfo = await this.readRecord(entry, entry.extraction);
+    if (!problemInfo) {
+      this.misses++;
+      return null;
+    }
+    const solutionRef = entry.solutions[language];
+    const solution = solutionRef ? await this.readRecord(entry, solutionRef) : null;
+    this.touch(entry);
+    return { problemInfo, solution };
+  }
+
+  /**
+   * Solution generated earlier for the same problem statement and language
+   */
+  public async recallSolution(problemInfo: any, language: string): Promise<any | null> {
+    await this.ensureLoaded();
+    const problemKey = problemKeyOf(problemInfo);
+    const entry = problemKey ? this.entries.get(problemKey) : undefined;
+    const ref = entry?.solutions[language];
+    if (!entry || !ref) {
+      this.misses++;
+      return null;
+    }
+
+    const solution = await this.readRecord(entry, ref);
+    if (!solution) {
+      this.misses++;
+      return null;
+    }
+    this.touch(entry);
+    return solution;
+  }
+
+  /**
+   * Debug result produced earlier for the same problem and screenshots
+   */
+  public async recallDebug(problemInfo: any, language: string, hashes: string[]): Promise<any | null> {
+    await this.ensureLoaded();
+    const problemKey = problemKeyOf(problemInfo);
+    const entry = problemKey ? this.entries.get(problemKey) : undefined;
+    const debug = entry?.debugs.find(
+      (candidate) => candidate.language === language && this.matches(candidate.hashes, hashes)
+    );
+    if (!entry || !debug) {
+      this.misses++;
+      return null;
+    }
+
+    const result = await this.readRecord(entry, debug.ref);
+    if (!result) {
+      this.misses++;
+      return null;
+    }
+    this.touch(entry);
+    return result;
+  }
+
+  private touch(entry: HistoryEntry): void {
+    this.hits++;
+    entry.lastUsedAt = Date.now();
+    this.scheduleIndexWrite();
+  }
+
+  private async record(
+    type: HistoryRecordType,
+    problemInfo: any,
+    hashes: string[],
+    data: any,
+    options: { language?: string; extractor?: string } = {}
+  ): Promise<void> {
+    await this.ensureLoaded();
+    const problemKey = problemKeyOf(problemInfo);
+    if (!problemKey) return;
+    await this.append({ type, problemKey, hashes, ...options, createdAt: Date.now(), data });
+  }
+
+  /**
+   * Remember a problem extraction and the extractor that produced it. Skipped
+   * when the same extractor already mapped these screenshots to this problem.
+   */
+  public async recordExtraction(extractor: string, hashes: string[], problemInfo: any): Promise<void> {
+    await this.ensureLoaded();
+    const problemKey = problemKeyOf(problemInfo);
+    const entry = problemKey ? this.entries.get(problemKey) : undefined;
+    if (entry && this.hasHashSet(entry, extractor, hashes)) return;
+    await this.record("extraction", problemInfo, hashes, problemInfo, { extractor });
+  }
+
+  public recordSolution(problemInfo: any, language: string, solution: any): Promise<void> {
+    return this.record("solution", problemInfo, [], solution, { language });
+  }
+
+  public recordDebug(problemInfo: any, language: string, hashes: string[], result: any): Promise<void> {
+    return this.record("debug", problemInfo, hashes, result, { language });
+  }
+
+  public getStats(): HistoryStats {
+    return {
+      problems: this.entries ? this.entries.size : 0,
+      bytes: this.logBytes,
+      hits: this.hits,
+      misses: this.misses
+    };
+  }
+
+  public async clear(): Promise<void> {
+    await this.ensureLoaded();
+    await this.enqueue(async () => {
+      await fs.promises.rm(this.logPath, { force: true });
+      this.entries = new Map();
+      this.logBytes = 0;
+      await this.writeIndex();
+    });
+  }
+}
+
+// Export a singleton instance
+export const historyStore = new HistoryStore();
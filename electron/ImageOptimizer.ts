@@ -0,0 +1,123 @@
+// ImageOptimizer.ts
+import { nativeImage, NativeImage } from "electron"
+import { Bitmap } from "./bitmap"
+import { ContentCrop } from "./ContentCropper"
+import { imageWorkerPool } from "./ImageWorkerPool"
+
+export type UploadImageFormat = "png" | "jpeg"
+
+export interface ImageOptimizationOptions {
+  maxDimension: number      // Longest edge in pixels, 0 disables resizing
+  format: UploadImageFormat
+  quality: number           // JPEG quality, 1-100
+  grayscale: boolean
+  autoCrop: boolean         // Crop to the text-heavy area before resizing
+}
+
+export interface OptimizedImage {
+  data: string              // Base64 encoded image
+  mimeType: string
+  originalBytes: number
+  optimizedBytes: number
+  width: number
+  height: number
+  crop: ContentCrop | null  // Area kept by auto-crop, null when the full image was used
+}
+
+// Largest edge each provider uses before it downsamples on its own side.
+// Sending more pixels than this only costs upload time.
+export const PROVIDER_MAX_DIMENSION: Record<"openai" | "gemini" | "anthropic", number> = {
+  openai: 2048,
+  gemini: 3072,
+  anthropic: 1568
+}
+
+/**
+ * Replace every pixel with its luma, on the image worker pool
+ */
+async function toGrayscale(image: NativeImage): Promise<NativeImage> {
+  const { width, height, data } = await imageWorkerPool.run({ kind: "grayscale", bitmap: toPixels(image) })
+  return nativeImage.createFromBitmap(Buffer.from(data.buffer, data.byteOffset, data.byteLength), { width, height })
+}
+
+/**
+ * Decode a captured image, failing on empty or undecodable bytes
+ */
+export function decodeImage(imageBuffer: Buffer): NativeImage {
+  const image = nativeImage.createFromBuffer(imageBuffer)
+  if (image.isEmpty()) {
+    throw new Error("Cannot decode an empty or undecodable image")
+  }
+  return image
+}
+
+/**
+ * Raw pixels of an image, for analysis on the image worker pool
+ */
+export function toPixels(image: NativeImage): Bitmap {
+  const { width, height } = image.getSize()
+  return { width, height, data: image.toBitmap() }
+}
+
+/**
+ * Crop to content, downscale, optionally desaturate and re-encode a captured
+ * PNG for upload. The crop is found beforehand by the content detector, which
+ * runs off the main thread.
+ * Falls back to the original bytes when the result would not be smaller.
+ */
+export async function optimizeImage(
+  imageBuffer: Buffer,
+  decoded: NativeImage,
+  crop: ContentCrop | null,
+  options: ImageOptimizationOptions
+): Promise<OptimizedImage> {
+  let image = decoded
+  const original = image.getSize()
+  // Cropping first also lets the kept area use more of the resize budget
+  if (crop) {
+    image = image.crop({ x: crop.x, y: crop.y, width: crop.width, height: crop.height })
+  }
+
+  const cropped = image.getSize()
+  const longestEdge = Math.max(cropped.width, cropped.height)
+  if (options.maxDimension > 0 && longestEdge > options.maxDimension) {
+    const scale = options.maxDimension / longestEdge
+    image = image.resize({
+      width: Math.round(cropped.width * scale),
+      height: Math.round(cropped.height * scale),
+      quality: "better"
+    })
+  }
+
+  if (options.grayscale) {
+    image = await toGrayscale(image)
+  }
+
+  const encoded =
+    options.format === "jpeg"
+      ? image.toJPEG(Math.min(100, Math.max(1, Math.round(options.quality))))
+      : image.toPNG()
+
+  if (encoded.length >= imageBuffer.length) {
+    return {
+      data: imageBuffer.toString("base64"),
+      mimeType: "image/png",
+      originalBytes: imageBuffer.length,
+      optimizedBytes: imageBuffer.length,
+      width: original.width,
+      height: original.height,
+      crop: null
+    }
+  }
+
+  const size = image.getSize()
+  return {
+    data: encoded.toString("base64"),
+    mimeType: options.format === "jpeg" ? "image/jpeg" : "image/png",
+    originalBytes: imageBuffer.length,
+    optimizedBytes: encoded.length,
+    width: size.width,
+    height: size.height,
+    crop
+  }
+}
@@ -0,0 +1,171 @@
+// ImageWorkerPool.ts
+import os from "node:os"
+import path from "node:path"
+import { Worker } from "node:worker_threads"
+import { Bitmap } from "./bitmap"
+import { ImageTask, ImageTaskKind, ImageTaskResults, runImageTask } from "./imageWorker"
+
+interface PendingTask {
+  id: number
+  task: ImageTask
+  transfer: ArrayBuffer[]
+  runInline: () => unknown   // Re-runs the task from the caller's pixels
+  resolve: (result: any) => void
+  reject: (error: Error) => void
+}
+
+interface PoolWorker {
+  worker: Worker
+  current: PendingTask | null
+  online: boolean
+}
+
+/**
+ * Pool of worker threads for the JS pixel loops: perceptual hashing, content
+ * detection and grayscale conversion. The main thread also services global
+ * shortcuts, window moves and IPC, so no per-pixel JS runs there. Pixels are
+ * copied once into a buffer that is transferred.
+ *
+ * Decoding, resizing, encoding and base64 still run on the main thread, on
+ * purpose: they are native nativeImage/Buffer calls, nativeImage is not
+ * available in workers, and JS codecs in a worker were slower end to end.
+ * Moving them off the main thread would need a utility process and is out of
+ * scope here.
+ */
+export class ImageWorkerPool {
+  // Leave a core for the main and renderer processes
+  private readonly SIZE = Math.max(1, Math.min(4, os.cpus().length - 1))
+  private readonly IDLE_TIMEOUT_MS = 60 * 1000
+
+  private workers: PoolWorker[] = []
+  private queue: PendingTask[] = []
+  private nextId = 0
+  private idleTimer: NodeJS.Timeout | null = null
+  // Set when a worker fails to start; tasks then run on the calling thread
+  private inline = false
+
+  /**
+   * Run a task on a worker. The pixels are copied, so the caller's buffer
+   * stays usable.
+   */
+  public run<K extends ImageTaskKind>(task: Extract<ImageTask, { kind: K }>): Promise<ImageTaskResults[K]> {
+    const runInline = () => runImageTask(task)
+    if (this.inline) {
+      return new Promise((resolve) => resolve(runInline()))
+    }
+
+    // A fresh copy owns its ArrayBuffer and can be transferred without
+    // detaching the caller's Buffer or Node's shared Buffer pool
+    const data = new Uint8Array(task.bitmap.data)
+    const bitmap: Bitmap = { ...task.bitmap, data }
+    return new Promise((resolve, reject) => {
+      this.queue.push({
+        id: this.nextId++,
+        task: { ...task, bitmap } as ImageTask,
+        transfer: [data.buffer],
+        runInline,
+        resolve,
+        reject
+      })
+      this.dispatch()
+    })
+  }
+
+  private dispatch(): void {
+    if (this.idleTimer) {
+      clearTimeout(this.idleTimer)
+      this.idleTimer = null
+    }
+
+    while (this.queue.length > 0) {
+      let slot = this.workers.find((candidate) => !candidate.current)
+      if (!slot && this.workers.length < this.SIZE) slot = this.spawn()
+      if (!slot) return
+
+      const pending = this.queue.shift()!
+      slot.current = pending
+      slot.worker.postMessage({ id: pending.id, task: pending.task }, pending.transfer)
+    }
+
+    if (this.workers.every((slot) => !slot.current)) this.scheduleShutdown()
+  }
+
+  private spawn(): PoolWorker | null {
+    let worker: Worker
+    try {
+      worker = new Worker(path.join(__dirname, "imageWorker.js"))
+    } catch (error) {
+      console.error("Could not start image worker, processing images inline:", error)
+      this.fallBackToInline()
+      return null
+    }
+
+    const slot: PoolWorker = { worker, current: null, online: false }
+    worker.once("online", () => (slot.online = true))
+    worker.on("message", (message: { id: number; result?: any; error?: string }) => {
+      const pending = slot.current
+      if (!pending || pending.id !== message.id) return
+      slot.current = null
+      if (message.error !== undefined) {
+        pending.reject(new Error(message.error))
+      } else {
+        pending.resolve(message.result)
+      }
+      this.dispatch()
+    })
+    worker.on("error", (error) => {
+      const pending = slot.current
+      slot.current = null
+      if (!slot.online) {
+        // The script could not be loaded, so no worker ever will be
+        console.error("Could not start image worker, processing images inline:", error)
+        if (pending) this.queue.unshift(pending)
+        this.fallBackToInline()
+        return
+      }
+      console.error("Image worker failed:", error)
+      pending?.reject(error)
+    })
+    worker.on("exit", () => {
+      this.workers = this.workers.filter((candidate) => candidate !== slot)
+      // A task still assigned here was lost with the worker
+      slot.current?.reject(new Error("Image worker exited"))
+      slot.current = null
+      this.dispatch()
+    })
+
+    this.workers.push(slot)
+    return slot
+  }
+
+  private fallBackToInline(): void {
+    this.inline = true
+    const queued = this.queue
+    this.queue = []
+    for (const pending of queued) {
+      try {
+        pending.resolve(pending.runInline())
+      } catch (error) {
+        pending.reject(error as Error)
+      }
+    }
+  }
+
+  private scheduleShutdown(): void {
+    if (this.idleTimer || this.workers.length === 0) return
+    this.idleTimer = setTimeout(() => {
+      this.idleTimer = null
+      void this.terminate()
+    }, this.IDLE_TIMEOUT_MS)
+  }
+
+  public async terminate(): Promise<void> {
+    const workers = this.workers
+    this.workers = []
+    await Promise.all(workers.map((slot) => slot.worker.terminate()))
+    if (workers.length > 0) console.log(`Stopped ${workers.length} image worker(s)`)
+  }
+}
+
+// Export a singleton instance
+export const imageWorkerPool = new ImageWorkerPool()
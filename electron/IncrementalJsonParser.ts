@@ -0,0 +1,203 @@
+// IncrementalJsonParser.ts
+
+type ParserState =
+  | "start"
+  | "keyOrEnd"
+  | "key"
+  | "colon"
+  | "value"
+  | "string"
+  | "nested"
+  | "primitive"
+  | "commaOrEnd"
+  | "done"
+
+const STRING_END = Symbol("string-end")
+
+const ESCAPES: Record<string, string> = {
+  '"': '"',
+  "\\": "\\",
+  "/": "/",
+  b: "\b",
+  f: "\f",
+  n: "\n",
+  r: "\r",
+  t: "\t"
+}
+
+export interface IncrementalJsonHandlers {
+  // Newly decoded text of a top-level string value
+  onStringDelta?: (key: string, delta: string) => void
+  // A top-level value has been received in full
+  onField?: (key: string, value: any) => void
+}
+
+/**
+ * Streaming parser for a single JSON object, fed with arbitrary chunks of
+ * model output. Top-level string values are reported as they decode and every
+ * top-level field as soon as it closes, so callers can act on a structured
+ * response long before it is complete. Nested values are buffered and parsed
+ * whole once they close.
+ */
+export class IncrementalJsonParser {
+  private state: ParserState = "start"
+  private key = ""
+  private text = ""                     // Decoded key or string value so far
+  private raw = ""                      // Raw text of a nested or primitive value
+  private depth = 0
+  private inNestedString = false
+  private escape: string | null = null  // Pending escape sequence after a backslash
+  private fields: Record<string, any> = {}
+
+  constructor(private readonly handlers: IncrementalJsonHandlers = {}) {}
+
+  public feed(chunk: string): void {
+    let delta = ""
+
+    for (const ch of chunk) {
+      switch (this.state) {
+        case "start":
+          // Skip anything before the object, such as a stray code fence
+          if (ch === "{") this.state = "keyOrEnd"
+          break
+
+        case "keyOrEnd":
+          if (ch === '"') {
+            this.state = "key"
+            this.text = ""
+          } else if (ch === "}") {
+            this.state = "done"
+          }
+          break
+
+        case "key":
+          if (this.readStringChar(ch) === STRING_END) {
+            this.key = this.text
+            this.state = "colon"
+          }
+          break
+
+        case "colon":
+          if (ch === ":") this.state = "value"
+          break
+
+        case "value":
+          if (/\s/.test(ch)) break
+          if (ch === '"') {
+            this.state = "string"
+            this.text = ""
+          } else if (ch === "{" || ch === "[") {
+            this.state = "nested"
+            this.raw = ch
+            this.depth = 1
+            this.inNestedString = false
+          } else {
+            this.state = "primitive"
+            this.raw = ch
+          }
+          break
+
+        case "string": {
+          const decoded = this.readStringChar(ch)
+          if (decoded === STRING_END) {
+            if (delta) this.handlers.onStringDelta?.(this.key, delta)
+            delta = ""
+            this.completeField(this.text)
+            this.state = "commaOrEnd"
+          } else {
+            delta += decoded
+          }
+          break
+        }
+
+        case "nested":
+          this.raw += ch
+          if (this.inNestedString) {
+            if (this.escape !== null) this.escape = null
+            else if (ch === "\\") this.escape = ""
+            else if (ch === '"') this.inNestedString = false
+          } else if (ch === '"') {
+            this.inNestedString = true
+          } else if (ch === "{" || ch === "[") {
+            this.depth++
+          } else if (ch === "}" || ch === "]") {
+            this.depth--
+            if (this.depth === 0) {
+              this.completeField(JSON.parse(this.raw))
+              this.state = "commaOrEnd"
+            }
+          }
+          break
+
+        case "primitive":
+          if (ch === "," || ch === "}" || /\s/.test(ch)) {
+            this.completeField(JSON.parse(this.raw))
+            this.state = ch === "," ? "keyOrEnd" : ch === "}" ? "done" : "commaOrEnd"
+          } else {
+            this.raw += ch
+          }
+          break
+
+        case "commaOrEnd":
+          if (ch === ",") this.state = "keyOrEnd"
+          else if (ch === "}") this.state = "done"
+          break
+
+        case "done":
+          break
+      }
+    }
+
+    if (delta) this.handlers.onStringDelta?.(this.key, delta)
+  }
+
+  /**
+   * Fields received in full so far
+   */
+  public getFields(): Record<string, any> {
+    return this.fields
+  }
+
+  public isComplete(): boolean {
+    return this.state === "done"
+  }
+
+  /**
+   * Decode one character of a JSON string, returning the decoded text (empty
+   * while inside an escape sequence) or STRING_END at the closing quote
+   */
+  private readStringChar(ch: string): string | typeof STRING_END {
+    if (this.escape !== null) {
+      if (this.escape.startsWith("u")) {
+        this.escape += ch
+        if (this.escape.length < 5) return ""
+        const decoded = String.fromCharCode(parseInt(this.escape.slice(1), 16))
+        this.escape = null
+        this.text += decoded
+        return decoded
+      }
+      if (ch === "u") {
+        this.escape = "u"
+        return ""
+      }
+      this.escape = null
+      const decoded = ESCAPES[ch] ?? ch
+      this.text += decoded
+      return decoded
+    }
+
+    if (ch === "\\") {
+      this.escape = ""
+      return ""
+    }
+    if (ch === '"') return STRING_END
+
+    this.text += ch
+    return ch
+  }
+
+  private completeField(value: any): void {
+    this.fields[this.key] = value
+    this.handlers.onField?.(this.key, value)
+  }
+}
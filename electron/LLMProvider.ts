@@ -0,0 +1,520 @@
+// LLMProvider.ts
+import http from "node:http"
+import https from "node:https"
+import * as axios from "axios"
+import { OpenAI } from "openai"
+import Anthropic from "@anthropic-ai/sdk"
+
+export type ProviderId = "openai" | "gemini" | "anthropic"
+
+export interface LLMImage {
+  data: string      // Base64 encoded image
+  mimeType: string
+}
+
+// JSON schema the response must conform to. Properties are listed in the
+// order the model should emit them, which matters for streaming consumers.
+export interface LLMResponseSchema {
+  name: string
+  description: string
+  schema: Record<string, any>
+}
+
+export interface LLMRequest {
+  model: string
+  systemPrompt?: string
+  prompt: string
+  images?: LLMImage[]
+  maxTokens?: number
+  temperature?: number
+  signal?: AbortSignal
+  // When set, the response is a JSON document matching the schema
+  responseSchema?: LLMResponseSchema
+  // When set, the response is streamed and each text delta reported as it arrives
+  onDelta?: (delta: string) => void
+}
+
+/**
+ * A chat model backend. Each provider maps the same request onto its own API,
+ * so the processing pipeline never branches on the provider. With a
+ * responseSchema, complete() returns (and streams) raw JSON text for every
+ * provider.
+ */
+export interface LLMProvider {
+  readonly id: ProviderId
+  readonly displayName: string
+  readonly defaultModel: string
+  complete(request: LLMRequest): Promise<string>
+  // User-facing explanation of a failed request, e.g. action = "generate solution"
+  describeError(error: any, action: string): string
+}
+
+// Interface for Gemini API responses
+interface GeminiResponse {
+  candidates: Array<{
+    content: {
+      parts: Array<{
+        text: string;
+      }>;
+    };
+    finishReason: string;
+  }>;
+}
+
+export const PROVIDER_DISPLAY_NAMES: Record<ProviderId, string> = {
+  openai: "OpenAI",
+  gemini: "Gemini",
+  anthropic: "Anthropic"
+}
+
+const REQUEST_TIMEOUT_MS = 60000
+const DEFAULT_MAX_TOKENS = 4000
+const DEFAULT_TEMPERATURE = 0.2
+
+// Sockets are kept open between requests so only the first call to each host
+// pays for the TCP and TLS handshake
+const keepAliveOptions = { keepAlive: true, keepAliveMsecs: 30000, maxSockets: 16 }
+export const sharedHttpAgent = new http.Agent(keepAliveOptions)
+export const sharedHttpsAgent = new https.Agent(keepAliveOptions)
+
+export function getKeepAliveAgent(baseURL: string): http.Agent {
+  return baseURL.startsWith("http:") ? sharedHttpAgent : sharedHttpsAgent
+}
+
+/**
+ * API base URL for a provider. Read lazily so values from .env apply; the
+ * OpenAI and Anthropic variables match the ones their SDKs already honour.
+ */
+export function getProviderBaseUrl(id: ProviderId): string {
+  switch (id) {
+    case "openai":
+      return process.env.OPENAI_BASE_URL || "https://api.openai.com/v1"
+    case "anthropic":
+      return process.env.ANTHROPIC_BASE_URL || "https://api.anthropic.com"
+    case "gemini":
+      return process.env.GEMINI_BASE_URL || "https://generativelanguage.googleapis.com"
+  }
+}
+
+export interface PrewarmResult {
+  host: string
+  reused: boolean     // The pool already held a warm socket to this host
+  dnsMs: number
+  connectMs: number
+  tlsMs: number
+  handshakeMs: number // Total setup time moved off the first real request
+}
+
+/**
+ * Open a connection to a provider's API host through the shared agent. The
+ * socket then sits in the keep-alive pool, so the next real request skips
+ * DNS, TCP and TLS setup.
+ */
+export function prewarmConnection(baseURL: string, timeoutMs = 5000): Promise<PrewarmResult> {
+  const url = new URL(baseURL)
+  const isHttps = url.protocol === "https:"
+  const client = isHttps ? https : http
+  const startedAt = performance.now()
+  const timings = { lookup: startedAt, connect: startedAt, secureConnect: startedAt }
+
+  return new Promise((resolve, reject) => {
+    let reused = false
+    const request = client.request(
+      {
+        protocol: url.protocol,
+        hostname: url.hostname,
+        port: url.port || undefined,
+        method: "HEAD",
+        path: "/",
+        agent: getKeepAliveAgent(baseURL),
+        timeout: timeoutMs
+      },
+      (response) => {
+        // Drain the response so the socket is released back to the pool
+        response.resume()
+        response.on("end", () => {
+          const handshakeEnd = isHttps ? timings.secureConnect : timings.connect
+          resolve({
+            host: url.host,
+            reused,
+            dnsMs: Math.round(timings.lookup - startedAt),
+            connectMs: Math.round(timings.connect - timings.lookup),
+            tlsMs: isHttps ? Math.round(timings.secureConnect - timings.connect) : 0,
+            handshakeMs: Math.round(handshakeEnd - startedAt)
+          })
+        })
+      }
+    )
+
+    request.on("socket", (socket) => {
+      if (!socket.connecting) {
+        reused = true
+        return
+      }
+      // IP literals never emit "lookup", which leaves DNS time at zero
+      socket.once("lookup", () => (timings.lookup = performance.now()))
+      socket.once("connect", () => (timings.connect = performance.now()))
+      socket.once("secureConnect", () => (timings.secureConnect = performance.now()))
+    })
+    request.on("timeout", () => request.destroy(new Error("Connection pre-warm timed out")))
+    request.on("error", reject)
+    request.end()
+  })
+}
+
+/**
+ * Gemini takes an OpenAPI-style schema: no additionalProperties, and an
+ * explicit propertyOrdering since it otherwise emits keys alphabetically
+ */
+function toGeminiSchema(schema: Record<string, any>): Record<string, any> {
+  const { additionalProperties, properties, items, ...rest } = schema
+  const converted: Record<string, any> = { ...rest }
+  if (properties) {
+    converted.properties = Object.fromEntries(
+      Object.entries(properties).map(([key, value]) => [key, toGeminiSchema(value as Record<string, any>)])
+    )
+    converted.propertyOrdering = Object.keys(properties)
+  }
+  if (items) {
+    converted.items = toGeminiSchema(items)
+  }
+  return converted
+}
+
+function getErrorStatus(error: any): number | undefined {
+  return error?.status ?? error?.response?.status
+}
+
+abstract class BaseProvider implements LLMProvider {
+  abstract readonly id: ProviderId
+  abstract readonly defaultModel: string
+
+  get displayName(): string {
+    return PROVIDER_DISPLAY_NAMES[this.id]
+  }
+
+  abstract complete(request: LLMRequest): Promise<string>
+
+  describeError(error: any, action: string): string {
+    const status = getErrorStatus(error)
+    if (status === 401) {
+      return `Invalid ${this.displayName} API key. Please check your settings.`
+    } else if (status === 429) {
+      return `${this.displayName} API rate limit exceeded or insufficient credits. Please try again later.`
+    } else if (status !== undefined && status >= 500) {
+      return `${this.displayName} server error. Please try again later.`
+    }
+    return `Failed to ${action} with ${this.displayName} API. Please check your API key or try again later.`
+  }
+
+  protected requireText(text: string | null | undefined): string {
+    if (!text) {
+      throw new Error(`Empty response from ${this.displayName} API`)
+    }
+    return text
+  }
+}
+
+class OpenAIProvider extends BaseProvider {
+  readonly id = "openai" as const
+  readonly defaultModel = "gpt-4o"
+  private client: OpenAI
+
+  constructor(apiKey: string) {
+    super()
+    const baseURL = getProviderBaseUrl("openai")
+    this.client = new OpenAI({
+      apiKey,
+      baseURL,
+      httpAgent: getKeepAliveAgent(baseURL),
+      timeout: REQUEST_TIMEOUT_MS,
+      maxRetries: 2   // Retry up to 2 times
+    })
+  }
+
+  async complete(request: LLMRequest): Promise<string> {
+    const messages: OpenAI.Chat.ChatCompletionMessageParam[] = []
+    if (request.systemPrompt) {
+      messages.push({ role: "system", content: request.systemPrompt })
+    }
+    messages.push({
+      role: "user",
+      content: request.images?.length
+        ? [
+            { type: "text", text: request.prompt },
+            ...request.images.map((image) => ({
+              type: "image_url" as const,
+              image_url: { url: `data:${image.mimeType};base64,${image.data}` }
+            }))
+          ]
+        : request.prompt
+    })
+
+    const params = {
+      model: request.model,
+      messages,
+      max_tokens: request.maxTokens ?? DEFAULT_MAX_TOKENS,
+      temperature: request.temperature ?? DEFAULT_TEMPERATURE,
+      ...(request.responseSchema
+        ? {
+            response_format: {
+              type: "json_schema" as const,
+              json_schema: {
+                name: request.responseSchema.name,
+                description: request.responseSchema.description,
+                schema: request.responseSchema.schema,
+                strict: true
+              }
+            }
+          }
+        : {})
+    }
+
+    if (request.onDelta) {
+      const stream = await this.client.chat.completions.create(
+        { ...params, stream: true },
+        { signal: request.signal }
+      )
+
+      let text = ""
+      for await (const chunk of stream) {
+        const delta = chunk.choices[0]?.delta?.content
+        if (delta) {
+          text += delta
+          request.onDelta(delta)
+        }
+      }
+      return this.requireText(text)
+    }
+
+    const response = await this.client.chat.completions.create(params, {
+      signal: request.signal
+    })
+    return this.requireText(response.choices[0]?.message?.content)
+  }
+}
+
+class GeminiProvider extends BaseProvider {
+  readonly id = "gemini" as const
+  readonly defaultModel = "gemini-2.0-flash"
+
+  constructor(private readonly apiKey: string) {
+    super()
+  }
+
+  async complete(request: LLMRequest): Promise<string> {
+    // Not every Gemini model accepts systemInstruction, so the system prompt
+    // leads the user turn
+    const text = request.systemPrompt
+      ? `${request.systemPrompt}\n\n${request.prompt}`
+      : request.prompt
+    const body = {
+      contents: [
+        {
+          role: "user",
+          parts: [
+            { text },
+            ...(request.images || []).map((image) => ({
+              inlineData: { mimeType: image.mimeType, data: image.data }
+            }))
+          ]
+        }
+      ],
+      generationConfig: {
+        temperature: request.temperature ?? DEFAULT_TEMPERATURE,
+        maxOutputTokens: request.maxTokens ?? DEFAULT_MAX_TOKENS,
+        ...(request.responseSchema
+          ? {
+              responseMimeType: "application/json",
+              responseSchema: toGeminiSchema(request.responseSchema.schema)
+            }
+          : {})
+      }
+    }
+
+    const endpoint = `${getProviderBaseUrl("gemini")}/v1beta/models/${request.model}`
+    const requestConfig = {
+      signal: request.signal,
+      // Header rather than query parameter keeps the key out of logged URLs
+      headers: { "x-goog-api-key": this.apiKey },
+      httpAgent: sharedHttpAgent,
+      httpsAgent: sharedHttpsAgent,
+      timeout: REQUEST_TIMEOUT_MS
+    }
+
+    if (request.onDelta) {
+      // Server-sent events endpoint, one JSON candidate chunk per "data:" line
+      const response = await axios.default.post(
+        `${endpoint}:streamGenerateContent?alt=sse`,
+        body,
+        { ...requestConfig, responseType: "stream" }
+      )
+      return this.requireText(
+        await this.readStream(response.data as NodeJS.ReadableStream, request.onDelta)
+      )
+    }
+
+    const response = await axios.default.post(`${endpoint}:generateContent`, body, requestConfig)
+    const responseData = response.data as GeminiResponse
+    return this.requireText(responseData.candidates?.[0]?.content?.parts?.[0]?.text)
+  }
+
+  /**
+   * Read a streamGenerateContent SSE body, reporting each text delta and
+   * returning the full concatenated text
+   */
+  private async readStream(
+    stream: NodeJS.ReadableStream,
+    onDelta: (delta: string) => void
+  ): Promise<string> {
+    let buffered = ""
+    let fullText = ""
+
+    const handleLine = (line: string) => {
+      const trimmed = line.trim()
+      if (!trimmed.startsWith("data:")) return
+
+      const payload = JSON.parse(trimmed.slice(5).trim()) as GeminiResponse
+      const parts = payload.candidates?.[0]?.content?.parts || []
+      const delta = parts.map((part) => part.text || "").join("")
+      if (delta) {
+        fullText += delta
+        onDelta(delta)
+      }
+    }
+
+    // Decode as UTF-8 so multi-byte characters split across chunks stay intact
+    stream.setEncoding("utf8")
+    for await (const chunk of stream) {
+      buffered += chunk.toString()
+      let newlineIndex = buffered.indexOf("\n")
+      while (newlineIndex !== -1) {
+        handleLine(buffered.slice(0, newlineIndex))
+        buffered = buffered.slice(newlineIndex + 1)
+        newlineIndex = buffered.indexOf("\n")
+      }
+    }
+    handleLine(buffered)
+
+    return fullText
+  }
+}
+
+class AnthropicProvider extends BaseProvider {
+  readonly id = "anthropic" as const
+  readonly defaultModel = "claude-3-7-sonnet-20250219"
+  private client: Anthropic
+
+  constructor(apiKey: string) {
+    super()
+    const baseURL = getProviderBaseUrl("anthropic")
+    this.client = new Anthropic({
+      apiKey,
+      baseURL,
+      httpAgent: getKeepAliveAgent(baseURL),
+      timeout: REQUEST_TIMEOUT_MS,
+      maxRetries: 2
+    })
+  }
+
+  async complete(request: LLMRequest): Promise<string> {
+    const params = {
+      model: request.model,
+      max_tokens: request.maxTokens ?? DEFAULT_MAX_TOKENS,
+      temperature: request.temperature ?? DEFAULT_TEMPERATURE,
+      ...(request.systemPrompt ? { system: request.systemPrompt } : {}),
+      // Structured output is a forced call to a tool whose input is the schema
+      ...(request.responseSchema
+        ? {
+            tools: [
+              {
+                name: request.responseSchema.name,
+                description: request.responseSchema.description,
+                input_schema: request.responseSchema.schema as Anthropic.Tool.InputSchema
+              }
+            ],
+            tool_choice: { type: "tool" as const, name: request.responseSchema.name }
+          }
+        : {}),
+      messages: [
+        {
+          role: "user" as const,
+          content: [
+            { type: "text" as const, text: request.prompt },
+            ...(request.images || []).map((image) => ({
+              type: "image" as const,
+              source: {
+                type: "base64" as const,
+                media_type: image.mimeType as "image/png" | "image/jpeg",
+                data: image.data
+              }
+            }))
+          ]
+        }
+      ]
+    }
+
+    if (request.onDelta) {
+      const stream = await this.client.messages.create(
+        { ...params, stream: true },
+        { signal: request.signal }
+      )
+
+      let text = ""
+      for await (const event of stream) {
+        if (event.type !== "content_block_delta") continue
+        const delta =
+          event.delta.type === "text_delta"
+            ? event.delta.text
+            : event.delta.type === "input_json_delta"
+              ? event.delta.partial_json
+              : ""
+        if (delta) {
+          text += delta
+          request.onDelta(delta)
+        }
+      }
+      return this.requireText(text)
+    }
+
+    const response = await this.client.messages.create(params, { signal: request.signal })
+    if (request.responseSchema) {
+      const toolBlock = response.content.find((block) => block.type === "tool_use") as
+        | { type: "tool_use"; input: unknown }
+        | undefined
+      return this.requireText(toolBlock ? JSON.stringify(toolBlock.input) : null)
+    }
+    const textBlock = response.content.find((block) => block.type === "text") as
+      | { type: "text"; text: string }
+      | undefined
+    return this.requireText(textBlock?.text)
+  }
+
+  describeError(error: any, action: string): string {
+    // Add specific handling for Claude's limitations
+    const status = getErrorStatus(error)
+    if (status === 429) {
+      return "Claude API rate limit exceeded. Please wait a few minutes before trying again."
+    } else if (status === 413 || (error?.message && error.message.includes("token"))) {
+      return "Your screenshots contain too much information for Claude to process. Switch to OpenAI or Gemini in settings which can handle larger inputs."
+    }
+    return super.describeError(error, action)
+  }
+}
+
+/**
+ * Create the adapter for a provider. Adding a provider means adding a class
+ * above and a case here.
+ */
+export function createProvider(id: ProviderId, apiKey: string): LLMProvider {
+  switch (id) {
+    case "openai":
+      return new OpenAIProvider(apiKey)
+    case "gemini":
+      return new GeminiProvider(apiKey)
+    case "anthropic":
+      return new AnthropicProvider(apiKey)
+    default:
+      throw new Error(`Unknown API provider: ${id}`)
+  }
+}
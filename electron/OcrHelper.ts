@@ -0,0 +1,144 @@
+// OcrHelper.ts
+import fs from "node:fs"
+import path from "node:path"
+import { app } from "electron"
+import type { Worker } from "tesseract.js"
+
+export interface OcrResult {
+  text: string;
+  confidence: number;   // Mean word confidence reported by Tesseract, 0-100
+  durationMs: number;
+}
+
+/**
+ * Local text recognition for screenshots, backed by Tesseract compiled to
+ * WASM. Tesseract runs in its own worker thread, so recognition never blocks
+ * the main process. The worker starts on first use and shuts down after a
+ * period of idleness. The WASM core ships with tesseract.js, but the English
+ * language data does not: it is downloaded from the tesseract.js CDN on first
+ * use and cached in userData, so the first use needs network access.
+ */
+export class OcrHelper {
+  private readonly IDLE_TIMEOUT_MS = 5 * 60 * 1000;
+  private readonly MAX_CACHED_RESULTS = 20;
+  // After a failed start, fail fast instead of waiting on the network again
+  private readonly RETRY_DELAY_MS = 60 * 1000;
+  private readonly LANGUAGE = "eng";
+
+  private worker: Promise<Worker> | null = null;
+  private startFailure: { error: Error; at: number } | null = null;
+  private idleTimer: NodeJS.Timeout | null = null;
+  private queue: Promise<unknown> = Promise.resolve();
+  // Results by screenshot path; paths are unique per capture
+  private results = new Map<string, OcrResult>();
+
+  private getCachePath(): string {
+    try {
+      return path.join(app.getPath('userData'), 'ocr');
+    } catch (err) {
+      console.warn('Could not access user data path for OCR data, using fallback');
+      return path.join(process.cwd(), 'ocr');
+    }
+  }
+
+  private getWorker(): Promise<Worker> {
+    if (this.startFailure && Date.now() - this.startFailure.at < this.RETRY_DELAY_MS) {
+      return Promise.reject(this.startFailure.error);
+    }
+    if (!this.worker) {
+      this.worker = (async () => {
+        // Loaded lazily so the module costs nothing unless OCR is enabled
+        const { createWorker } = await import("tesseract.js");
+        const cachePath = this.getCachePath();
+        const cached = fs.existsSync(path.join(cachePath, `${this.LANGUAGE}.traineddata`));
+        if (!cached) console.log("Downloading OCR language data (first use, about 10 MB)");
+
+        const startedAt = Date.now();
+        try {
+          const worker = await createWorker(this.LANGUAGE, undefined, { cachePath });
+          console.log(`OCR worker ready in ${Date.now() - startedAt} ms`);
+          return worker;
+        } catch (error: any) {
+          if (cached) throw error;
+          throw new Error(
+            "Could not download the OCR language data. Local text recognition needs network " +
+            "access once to fetch it from the tesseract.js CDN (cdn.jsdelivr.net): " +
+            (error?.message || String(error))
+          );
+        }
+      })();
+      this.worker.then(
+        () => {
+          this.startFailure = null;
+        },
+        (error) => {
+          console.error("Failed to start OCR worker, screenshots will be sent as images:", error);
+          this.startFailure = { error, at: Date.now() };
+          this.worker = null;
+        }
+      );
+    }
+    return this.worker;
+  }
+
+  private scheduleShutdown(): void {
+    if (this.idleTimer) clearTimeout(this.idleTimer);
+    this.idleTimer = setTimeout(() => {
+      this.idleTimer = null;
+      void this.terminate();
+    }, this.IDLE_TIMEOUT_MS);
+  }
+
+  /**
+   * Start the worker ahead of the first recognition
+   */
+  public warmUp(): void {
+    this.getWorker().catch(() => {});
+    this.scheduleShutdown();
+  }
+
+  /**
+   * Recognize the text in an encoded image. Results are cached per screenshot,
+   * and requests are serialized because one worker handles one image at a time.
+   */
+  public recognize(key: string, image: Buffer): Promise<OcrResult> {
+    const cached = this.results.get(key);
+    if (cached) return Promise.resolve(cached);
+
+    const run = this.queue.then(async () => {
+      const worker = await this.getWorker();
+      const startedAt = Date.now();
+      const { data } = await worker.recognize(image);
+      const result: OcrResult = {
+        text: data.text.trim(),
+        confidence: data.confidence,
+        durationMs: Date.now() - startedAt
+      };
+
+      this.results.set(key, result);
+      const oldest = this.results.keys().next().value;
+      if (this.results.size > this.MAX_CACHED_RESULTS && oldest !== undefined) {
+        this.results.delete(oldest);
+      }
+      return result;
+    });
+    this.queue = run.catch(() => {});
+    this.scheduleShutdown();
+    return run;
+  }
+
+  public async terminate(): Promise<void> {
+    const worker = this.worker;
+    this.worker = null;
+    if (!worker) return;
+    try {
+      await (await worker).terminate();
+      console.log("OCR worker stopped");
+    } catch (error) {
+      console.error("Error stopping OCR worker:", error);
+    }
+  }
+}
+
+// Export a singleton instance
+export const ocrHelper = new OcrHelper();
@@ -1,69 +1,136 @@
 // ProcessingHelper.ts
-import fs from "node:fs"
 import path from "node:path"
 import { ScreenshotHelper } from "./ScreenshotHelper"
 import { IProcessingHelperDeps } from "./main"
 import * as axios from "axios"
-import { app, BrowserWindow, dialog } from "electron"
-import { OpenAI } from "openai"
+import { app, dialog } from "electron"
 import { configHelper } from "./ConfigHelper"
-import Anthropic from '@anthropic-ai/sdk';
-
-// Interface for Gemini API requests
-interface GeminiMessage {
-  role: string;
-  parts: Array<{
-    text?: string;
-    inlineData?: {
-      mimeType: string;
-      data: string;
-    }
-  }>;
-}
+import { extractionCache } from "./ExtractionCache"
+import { historyStore } from "./HistoryStore"
+import { ocrHelper } from "./OcrHelper"
+import { ImageOptimizationOptions, PROVIDER_MAX_DIMENSION } from "./ImageOptimizer"
+import {
+  createProvider,
+  getProviderBaseUrl,
+  LLMProvider,
+  LLMRequest,
+  LLMResponseSchema,
+  prewarmConnection,
+  PROVIDER_DISPLAY_NAMES
+} from "./LLMProvider"
+import { IncrementalJsonParser } from "./IncrementalJsonParser"
+import { tracer } from "./Tracer"
+
+type UploadScreenshot = { path: string; data: string; mimeType: string };
+
+// Structured response schemas. Properties are listed in the order the model
+// emits them, so the problem arrives first and the code before the explanations.
+const PROBLEM_SCHEMA = {
+  type: "object",
+  properties: {
+    problem_statement: { type: "string" },
+    constraints: { type: "string" },
+    example_input: { type: "string" },
+    example_output: { type: "string" }
+  },
+  required: ["problem_statement", "constraints", "example_input", "example_output"],
+  additionalProperties: false
+};
+
+const SOLUTION_PROPERTIES = {
+  code: {
+    type: "string",
+    description: "Complete, well-commented implementation without markdown fences"
+  },
+  thoughts: {
+    type: "array",
+    items: { type: "string" },
+    description: "Key insights and reasoning behind the approach"
+  },
+  time_complexity: {
+    type: "string",
+    description: "Big-O time complexity followed by a detailed explanation"
+  },
+  space_complexity: {
+    type: "string",
+    description: "Big-O space complexity followed by a detailed explanation"
+  }
+};
+
+const EXTRACTION_RESPONSE: LLMResponseSchema = {
+  name: "coding_problem",
+  description: "The coding problem shown in the screenshots",
+  schema: PROBLEM_SCHEMA
+};
+
+const SOLUTION_RESPONSE: LLMResponseSchema = {
+  name: "coding_solution",
+  description: "A solution to the coding problem with its analysis",
+  schema: {
+    type: "object",
+    properties: SOLUTION_PROPERTIES,
+    required: Object.keys(SOLUTION_PROPERTIES),
+    additionalProperties: false
+  }
+};
+
+const ONE_SHOT_RESPONSE: LLMResponseSchema = {
+  name: "coding_problem_and_solution",
+  description: "The coding problem shown in the screenshots and a solution to it",
+  schema: {
+    type: "object",
+    properties: { problem: PROBLEM_SCHEMA, ...SOLUTION_PROPERTIES },
+    required: ["problem", ...Object.keys(SOLUTION_PROPERTIES)],
+    additionalProperties: false
+  }
+};
 
-interface GeminiResponse {
-  candidates: Array<{
-    content: {
-      parts: Array<{
-        text: string;
-      }>;
-    };
-    finishReason: string;
-  }>;
-}
-interface AnthropicMessage {
-  role: 'user' | 'assistant';
-  content: Array<{
-    type: 'text' | 'image';
-    text?: string;
-    source?: {
-      type: 'base64';
-      media_type: string;
-      data: string;
-    };
-  }>;
+function formatBytes(bytes: number): string {
+  if (bytes >= 1024 * 1024) return `${(bytes / (1024 * 1024)).toFixed(1)} MB`;
+  return `${Math.round(bytes / 1024)} KB`;
 }
+
 export class ProcessingHelper {
   private deps: IProcessingHelperDeps
   private screenshotHelper: ScreenshotHelper
-  private openaiClient: OpenAI | null = null
-  private geminiApiKey: string | null = null
-  private anthropicClient: Anthropic | null = null
+  private provider: LLMProvider | null = null
+  // Second provider raced against the primary one when hedging is enabled
+  private hedgeProvider: LLMProvider | null = null
+
+  // Last connection pre-warm per base URL, used to avoid re-warming a socket that is still pooled
+  private lastPrewarmAt = new Map<string, number>()
+  private readonly PREWARM_INTERVAL_MS = 30000
+
+  // Reported by the renderer when it is ready and whenever they change
+  private rendererLanguage: string | null = null
+  private credits = 999 // Unlimited credits in this version
+
+  // Less recognized text than this is unlikely to be a whole problem statement
+  private readonly MIN_OCR_CHARACTERS = 80
 
   // AbortControllers for API requests
   private currentProcessingAbortController: AbortController | null = null
   private currentExtraProcessingAbortController: AbortController | null = null
 
+  // Extraction started in the background right after a capture (opt-in)
+  private speculativeExtraction: {
+    signature: string
+    controller: AbortController
+    promise: Promise<{ success: boolean; data?: any; error?: string }>
+  } | null = null
+
   constructor(deps: IProcessingHelperDeps) {
     this.deps = deps
     this.screenshotHelper = deps.getScreenshotHelper()
     
     // Initialize AI client based on config
     this.initializeAIClient();
+    this.prewarmConnection("startup");
     
     // Listen for config changes to re-initialize the AI client
     configHelper.on('config-updated', () => {
       this.initializeAIClient();
+      this.prewarmConnection("config updated");
     });
   }
   
@@ -72,175 +139,408 @@ export class ProcessingHelper {
    */
   private initializeAIClient(): void {
     try {
-      const config = configHelper.loadConfig();
+      const config = configHelper.getConfig();
       
-      if (config.apiProvider === "openai") {
-        if (config.apiKey) {
-          this.openaiClient = new OpenAI({ 
-            apiKey: config.apiKey,
-            timeout: 60000, // 60 second timeout
-            maxRetries: 2   // Retry up to 2 times
-          });
-          this.geminiApiKey = null;
-          this.anthropicClient = null;
-          console.log("OpenAI client initialized successfully");
-        } else {
-          this.openaiClient = null;
-          this.geminiApiKey = null;
-          this.anthropicClient = null;
-          console.warn("No API key available, OpenAI client not initialized");
-        }
-      } else if (config.apiProvider === "gemini"){
-        // Gemini client initialization
-        this.openaiClient = null;
-        this.anthropicClient = null;
-        if (config.apiKey) {
-          this.geminiApiKey = config.apiKey;
-          console.log("Gemini API key set successfully");
-        } else {
-          this.openaiClient = null;
-          this.geminiApiKey = null;
-          this.anthropicClient = null;
-          console.warn("No API key available, Gemini client not initialized");
-        }
-      } else if (config.apiProvider === "anthropic") {
-        // Reset other clients
-        this.openaiClient = null;
-        this.geminiApiKey = null;
-        if (config.apiKey) {
-          this.anthropicClient = new Anthropic({
-            apiKey: config.apiKey,
-            timeout: 60000,
-            maxRetries: 2
-          });
-          console.log("Anthropic client initialized successfully");
-        } else {
-          this.openaiClient = null;
-          this.geminiApiKey = null;
-          this.anthropicClient = null;
-          console.warn("No API key available, Anthropic client not initialized");
-        }
+      if (config.apiKey) {
+        this.provider = createProvider(config.apiProvider, config.apiKey);
+        console.log(`${this.provider.displayName} client initialized successfully`);
+      } else {
+        this.provider = null;
+        console.warn(`No API key available, ${PROVIDER_DISPLAY_NAMES[config.apiProvider]} client not initialized`);
+      }
+
+      if (config.hedgeEnabled && config.hedgeApiKey && config.hedgeProvider !== config.apiProvider) {
+        this.hedgeProvider = createProvider(config.hedgeProvider, config.hedgeApiKey);
+        console.log(`${this.hedgeProvider.displayName} hedge client initialized (delay ${config.hedgeDelayMs} ms)`);
+      } else {
+        this.hedgeProvider = null;
       }
     } catch (error) {
       console.error("Failed to initialize AI client:", error);
-      this.openaiClient = null;
-      this.geminiApiKey = null;
-      this.anthropicClient = null;
+      this.provider = null;
+      this.hedgeProvider = null;
     }
   }
 
-  private async waitForInitialization(
-    mainWindow: BrowserWindow
-  ): Promise<void> {
-    let attempts = 0
-    const maxAttempts = 50 // 5 seconds total
-
-    while (attempts < maxAttempts) {
-      const isInitialized = await mainWindow.webContents.executeJavaScript(
-        "window.__IS_INITIALIZED__"
-      )
-      if (isInitialized) return
-      await new Promise((resolve) => setTimeout(resolve, 100))
-      attempts++
+  /**
+   * Open a connection to the active provider's host ahead of the first
+   * request, so DNS, TCP and TLS setup happen off the critical path
+   */
+  public prewarmConnection(reason: string): void {
+    for (const provider of [this.provider, this.hedgeProvider]) {
+      if (provider) this.prewarmProvider(provider, reason);
     }
-    throw new Error("App failed to initialize after 5 seconds")
   }
 
-  private async getCredits(): Promise<number> {
-    const mainWindow = this.deps.getMainWindow()
-    if (!mainWindow) return 999 // Unlimited credits in this version
+  private prewarmProvider(provider: LLMProvider, reason: string): void {
+    const baseURL = getProviderBaseUrl(provider.id);
+    const now = Date.now();
+    if (now - (this.lastPrewarmAt.get(baseURL) || 0) < this.PREWARM_INTERVAL_MS) {
+      return;
+    }
+    this.lastPrewarmAt.set(baseURL, now);
 
-    try {
-      await this.waitForInitialization(mainWindow)
-      return 999 // Always return sufficient credits to work
-    } catch (error) {
-      console.error("Error getting credits:", error)
-      return 999 // Unlimited credits as fallback
+    prewarmConnection(baseURL)
+      .then((result) => {
+        if (result.reused) {
+          console.log(`Connection to ${result.host} already warm (${reason})`);
+          return;
+        }
+        console.log(
+          `Pre-warmed connection to ${result.host} (${reason}): first request saves ~${result.handshakeMs} ms ` +
+          `(DNS ${result.dnsMs} ms, TCP ${result.connectMs} ms, TLS ${result.tlsMs} ms)`
+        );
+      })
+      .catch((error) => {
+        this.lastPrewarmAt.delete(baseURL);
+        console.warn(`Connection pre-warm to ${baseURL} failed:`, error.message || error);
+      });
+  }
+
+  /**
+   * Current provider adapter, retrying initialization once if needed
+   */
+  private getProvider(): LLMProvider | null {
+    if (!this.provider) {
+      this.initializeAIClient();
     }
+    return this.provider;
   }
 
-  private async getLanguage(): Promise<string> {
-    try {
-      // Get language from config
-      const config = configHelper.loadConfig();
-      if (config.language) {
-        return config.language;
+  /**
+   * Record the state the renderer reports once it has mounted. The renderer
+   * sends this once per load and pushes later changes, so reads are synchronous.
+   */
+  public setRendererState(update: { language?: string; credits?: number }): void {
+    if (typeof update.language === "string" && update.language) {
+      this.rendererLanguage = update.language
+    }
+    if (typeof update.credits === "number") {
+      this.credits = update.credits
+    }
+  }
+
+  public getCredits(): number {
+    return this.credits
+  }
+
+  private getLanguage(): string {
+    // The config is authoritative; the renderer's value covers a config without one
+    return configHelper.getConfig().language || this.rendererLanguage || "python"
+  }
+
+  /**
+   * Model to request from a provider. Configured models belong to the primary
+   * provider; a hedge provider always uses its default model.
+   */
+  private getModelFor(provider: LLMProvider, configuredModel: string): string {
+    return provider === this.provider && configuredModel ? configuredModel : provider.defaultModel;
+  }
+
+  /**
+   * Send a request to the primary provider and, when hedging is enabled, the
+   * same request to the hedge provider after hedgeDelayMs (or as soon as the
+   * primary fails). The first provider to answer wins and the other request
+   * is aborted. When streaming, the first provider to produce a token wins,
+   * so the renderer only ever sees one stream.
+   */
+  private completeWithHedge(
+    stage: string,
+    buildRequest: (provider: LLMProvider) => Omit<LLMRequest, "signal" | "onDelta">,
+    signal: AbortSignal,
+    onDelta?: (delta: string) => void
+  ): Promise<string> {
+    const primary = this.provider;
+    const hedge = this.hedgeProvider;
+    if (!hedge) {
+      return this.tracedComplete(stage, primary, { ...buildRequest(primary), signal, onDelta });
+    }
+
+    const hedgeDelayMs = Math.max(0, configHelper.getConfig().hedgeDelayMs || 0);
+    const startedAt = Date.now();
+
+    return new Promise<string>((resolve, reject) => {
+      const attempts: Array<{ provider: LLMProvider; controller: AbortController }> = [];
+      const errors = new Map<LLMProvider, any>();
+      let winner: LLMProvider | null = null;
+      let settled = false;
+      let hedgeTimer: NodeJS.Timeout | null = null;
+
+      const settle = (finish: () => void) => {
+        if (settled) return;
+        settled = true;
+        if (hedgeTimer) clearTimeout(hedgeTimer);
+        signal.removeEventListener("abort", onAbort);
+        finish();
+      };
+
+      const onAbort = () => {
+        attempts.forEach((attempt) => attempt.controller.abort());
+        settle(() => reject(new Error("Request aborted")));
+      };
+      signal.addEventListener("abort", onAbort, { once: true });
+
+      // Commit to a provider and abort the other one
+      const claim = (provider: LLMProvider): boolean => {
+        if (winner) return winner === provider;
+        winner = provider;
+        if (hedgeTimer) clearTimeout(hedgeTimer);
+        attempts
+          .filter((attempt) => attempt.provider !== provider)
+          .forEach((attempt) => attempt.controller.abort());
+        return true;
+      };
+
+      const launch = (provider: LLMProvider) => {
+        if (settled || attempts.some((attempt) => attempt.provider === provider)) return;
+
+        const controller = new AbortController();
+        attempts.push({ provider, controller });
+        this
+          .tracedComplete(stage, provider, {
+            ...buildRequest(provider),
+            signal: controller.signal,
+            onDelta: onDelta
+              ? (delta) => {
+                  if (claim(provider)) onDelta(delta);
+                }
+              : undefined
+          })
+          .then(
+            (text) => {
+              if (!claim(provider)) return;
+              console.log(`${stage}: ${provider.displayName} won the hedged request in ${Date.now() - startedAt} ms`);
+              settle(() => resolve(text));
+            },
+            (error) => {
+              if (winner === provider) {
+                settle(() => reject(error));
+                return;
+              }
+              if (winner || settled) return;
+
+              errors.set(provider, error);
+              if (provider === primary) {
+                // Don't wait out the delay once the primary has failed
+                launch(hedge);
+              }
+              if (errors.size === 2) {
+                settle(() => reject(errors.get(primary)));
+              }
+            }
+          );
+      };
+
+      launch(primary);
+      if (hedgeDelayMs === 0) {
+        launch(hedge);
+      } else {
+        hedgeTimer = setTimeout(() => launch(hedge), hedgeDelayMs);
       }
-      
-      // Fallback to window variable if config doesn't have language
-      const mainWindow = this.deps.getMainWindow()
-      if (mainWindow) {
+    });
+  }
+
+  /**
+   * Call a provider inside a trace span, marking when its first token arrives
+   */
+  private tracedComplete(stage: string, provider: LLMProvider, request: LLMRequest): Promise<string> {
+    const lane = `request:${provider.id}`;
+    const span = tracer.startSpan(stage, lane, {
+      model: request.model,
+      images: request.images?.length || 0
+    });
+
+    let awaitingFirstToken = true;
+    const onDelta = request.onDelta
+      ? (delta: string) => {
+          if (awaitingFirstToken) {
+            awaitingFirstToken = false;
+            tracer.instant("first token", lane, { stage });
+          }
+          request.onDelta(delta);
+        }
+      : undefined;
+
+    return provider.complete({ ...request, onDelta }).then(
+      (text) => {
+        span.end({ outputChars: text.length });
+        return text;
+      },
+      (error) => {
+        span.end({ error: error?.message || String(error) });
+        throw error;
+      }
+    );
+  }
+
+  /**
+   * Fetch screenshots from the in-memory store and run them through the
+   * pre-upload optimization stage (crop to content, downscale to the provider's
+   * useful resolution, re-encode, optional grayscale). Unreadable files are dropped.
+   */
+  private async loadScreenshotsForUpload(
+    paths: string[],
+    traceLane = "processing"
+  ): Promise<UploadScreenshot[]> {
+    const config = configHelper.getConfig();
+    const span = tracer.startSpan("load screenshots", traceLane, { screenshots: paths.length });
+    // With optimization off, auto-crop still runs but the crop is sent as a lossless PNG
+    const options: ImageOptimizationOptions = config.imageOptimization
+      ? {
+          maxDimension: config.imageMaxDimension > 0
+            ? config.imageMaxDimension
+            : PROVIDER_MAX_DIMENSION[config.apiProvider],
+          format: config.imageFormat === "png" ? "png" : "jpeg",
+          quality: config.imageQuality,
+          grayscale: config.imageGrayscale,
+          autoCrop: config.autoCrop
+        }
+      : { maxDimension: 0, format: "png", quality: 100, grayscale: false, autoCrop: config.autoCrop };
+
+    let originalBytes = 0;
+    let uploadBytes = 0;
+    const screenshots = await Promise.all(
+      paths.map(async (path) => {
         try {
-          await this.waitForInitialization(mainWindow)
-          const language = await mainWindow.webContents.executeJavaScript(
-            "window.__LANGUAGE__"
-          )
+          if (!config.imageOptimization && !config.autoCrop) {
+            const data = await this.screenshotHelper.getScreenshotBase64(path);
+            const bytes = Math.floor((data.length * 3) / 4);
+            originalBytes += bytes;
+            uploadBytes += bytes;
+            return { path, data, mimeType: "image/png" };
+          }
 
-          if (
-            typeof language === "string" &&
-            language !== undefined &&
-            language !== null
-          ) {
-            return language;
+          const optimized = await this.screenshotHelper.getOptimizedScreenshot(path, options);
+          if (optimized.crop && config.cropOverlay) {
+            this.sendContentCrop(path);
           }
+          originalBytes += optimized.originalBytes;
+          uploadBytes += optimized.optimizedBytes;
+          return { path, data: optimized.data, mimeType: optimized.mimeType };
         } catch (err) {
-          console.warn("Could not get language from window", err);
+          console.error(`Error reading screenshot ${path}:`, err);
+          return null;
         }
+      })
+    );
+
+    if (originalBytes > 0) {
+      const savedBytes = originalBytes - uploadBytes;
+      console.log(
+        `Upload payload: ${formatBytes(uploadBytes)} for ${paths.length} screenshot(s), ` +
+        `saved ${formatBytes(savedBytes)} (${Math.round((savedBytes / originalBytes) * 100)}%) by optimization`
+      );
+    }
+    span.end({ originalBytes, uploadBytes });
+
+    return screenshots.filter(Boolean);
+  }
+
+  /**
+   * Tell the renderer which area of a screenshot auto-crop kept
+   */
+  private sendContentCrop(path: string): void {
+    const crop = this.screenshotHelper.getContentCrop(path);
+    const mainWindow = this.deps.getMainWindow();
+    if (crop && mainWindow && !mainWindow.isDestroyed()) {
+      mainWindow.webContents.send("screenshot-crop", { path, crop });
+    }
+  }
+
+  /**
+   * Recognize a new screenshot in the background, so the OCR pre-pass is
+   * usually a cache hit by the time processing starts
+   */
+  public prefetchOcr(path: string): void {
+    if (!path || !configHelper.getConfig().ocrEnabled) return;
+    void this.screenshotHelper
+      .getContentImage(path)
+      .then((image) => ocrHelper.recognize(path, image))
+      .catch((error) => console.warn("Background OCR failed:", error));
+  }
+
+  /**
+   * Local OCR pre-pass. Returns the text of every screenshot when all of them
+   * were read with enough confidence, or null to send the images instead.
+   */
+  private async recognizeScreenshotText(
+    screenshots: UploadScreenshot[],
+    signal: AbortSignal
+  ): Promise<string | null> {
+    const config = configHelper.getConfig();
+    if (!config.ocrEnabled || screenshots.length === 0) return null;
+
+    const span = tracer.startSpan("ocr", "ocr", { screenshots: screenshots.length });
+    try {
+      const results = await Promise.all(
+        screenshots.map(async (screenshot) =>
+          ocrHelper.recognize(screenshot.path, await this.screenshotHelper.getContentImage(screenshot.path))
+        )
+      );
+      if (signal.aborted) {
+        span.end({ used: false });
+        return null;
       }
-      
-      // Default fallback
-      return "python";
-    } catch (error) {
-      console.error("Error getting language:", error)
-      return "python"
+
+      const confidence = Math.min(...results.map((result) => result.confidence));
+      const text = results
+        .map((result, index) => (results.length > 1 ? `[Screenshot ${index + 1}]\n${result.text}` : result.text))
+        .join("\n\n");
+      const characters = results.reduce((total, result) => total + result.text.length, 0);
+      const used = confidence >= config.ocrMinConfidence && characters >= this.MIN_OCR_CHARACTERS;
+      span.end({ confidence, characters, used });
+
+      if (!used) {
+        console.log(
+          `OCR confidence ${Math.round(confidence)} (minimum ${config.ocrMinConfidence}), ` +
+          `${characters} characters: sending images instead`
+        );
+        return null;
+      }
+      console.log(`OCR read ${characters} characters at confidence ${Math.round(confidence)}, sending text instead of images`);
+      return text;
+    } catch (error: any) {
+      span.end({ error: error?.message || String(error) });
+      console.warn("OCR failed, sending images instead:", error);
+      return null;
     }
   }
 
+  /**
+   * Log how long an image request took relative to the bytes it uploaded
+   */
+  private logUploadTiming(stage: string, screenshots: UploadScreenshot[] | string, startedAt: number): void {
+    // Measured as base64, which is what actually goes over the wire; OCR text is sent as is
+    const payloadBytes = typeof screenshots === "string"
+      ? Buffer.byteLength(screenshots)
+      : screenshots.reduce((total, screenshot) => total + screenshot.data.length, 0);
+    console.log(
+      `${stage} request uploaded ${formatBytes(payloadBytes)} and completed in ${Date.now() - startedAt} ms`
+    );
+  }
+
   public async processScreenshots(): Promise<void> {
     const mainWindow = this.deps.getMainWindow()
     if (!mainWindow) return
 
-    const config = configHelper.loadConfig();
+    const config = configHelper.getConfig();
     
     // First verify we have a valid AI client
-    if (config.apiProvider === "openai" && !this.openaiClient) {
-      this.initializeAIClient();
-      
-      if (!this.openaiClient) {
-        console.error("OpenAI client not initialized");
-        mainWindow.webContents.send(
-          this.deps.PROCESSING_EVENTS.API_KEY_INVALID
-        );
-        return;
-      }
-    } else if (config.apiProvider === "gemini" && !this.geminiApiKey) {
-      this.initializeAIClient();
-      
-      if (!this.geminiApiKey) {
-        console.error("Gemini API key not initialized");
-        mainWindow.webContents.send(
-          this.deps.PROCESSING_EVENTS.API_KEY_INVALID
-        );
-        return;
-      }
-    } else if (config.apiProvider === "anthropic" && !this.anthropicClient) {
-      // Add check for Anthropic client
-      this.initializeAIClient();
-      
-      if (!this.anthropicClient) {
-        console.error("Anthropic client not initialized");
-        mainWindow.webContents.send(
-          this.deps.PROCESSING_EVENTS.API_KEY_INVALID
-        );
-        return;
-      }
+    if (!this.getProvider()) {
+      console.error(`${PROVIDER_DISPLAY_NAMES[config.apiProvider]} client not initialized`);
+      mainWindow.webContents.send(
+        this.deps.PROCESSING_EVENTS.API_KEY_INVALID
+      );
+      return;
     }
 
     const view = this.deps.getView()
     console.log("Processing screenshots in view:", view)
 
     if (view === "queue") {
-      mainWindow.webContents.send(this.deps.PROCESSING_EVENTS.INITIAL_START)
+      // Continues the trace started by the first capture; the renderer reports its spans under it
+      const traceId = tracer.ensureTrace("problem")
+      mainWindow.webContents.send(this.deps.PROCESSING_EVENTS.INITIAL_START, { traceId })
       const screenshotQueue = this.screenshotHelper.getScreenshotQueue()
       console.log("Processing main queue screenshots:", screenshotQueue)
       
@@ -251,36 +551,24 @@ export class ProcessingHelper {
         return;
       }
 
-      // Check that files actually exist
-      const existingScreenshots = screenshotQueue.filter(path => fs.existsSync(path));
+      // Check that the screenshots are still available
+      const existingScreenshots = screenshotQueue.filter(path => this.screenshotHelper.hasScreenshot(path));
       if (existingScreenshots.length === 0) {
-        console.log("Screenshot files don't exist on disk");
+        console.log("Screenshot files don't exist in memory or on disk");
         mainWindow.webContents.send(this.deps.PROCESSING_EVENTS.NO_SCREENSHOTS);
         return;
       }
 
+      const processingSpan = tracer.startSpan("process screenshots", "processing", {
+        screenshots: existingScreenshots.length
+      })
       try {
         // Initialize AbortController
         this.currentProcessingAbortController = new AbortController()
         const { signal } = this.currentProcessingAbortController
 
-        const screenshots = await Promise.all(
-          existingScreenshots.map(async (path) => {
-            try {
-              return {
-                path,
-                preview: await this.screenshotHelper.getImagePreview(path),
-                data: fs.readFileSync(path).toString('base64')
-              };
-            } catch (err) {
-              console.error(`Error reading screenshot ${path}:`, err);
-              return null;
-            }
-          })
-        )
-
-        // Filter out any nulls from failed screenshots
-        const validScreenshots = screenshots.filter(Boolean);
+        // Read and optimize screenshots; failed reads are dropped
+        const validScreenshots = await this.loadScreenshotsForUpload(existingScreenshots);
         
         if (validScreenshots.length === 0) {
           throw new Error("Failed to load screenshot data");
@@ -335,6 +623,7 @@ export class ProcessingHelper {
         this.deps.setView("queue")
       } finally {
         this.currentProcessingAbortController = null
+        processingSpan.end()
       }
     } else {
       // view == 'solutions'
@@ -350,15 +639,19 @@ export class ProcessingHelper {
         return;
       }
 
-      // Check that files actually exist
-      const existingExtraScreenshots = extraScreenshotQueue.filter(path => fs.existsSync(path));
+      // Check that the screenshots are still available
+      const existingExtraScreenshots = extraScreenshotQueue.filter(path => this.screenshotHelper.hasScreenshot(path));
       if (existingExtraScreenshots.length === 0) {
-        console.log("Extra screenshot files don't exist on disk");
+        console.log("Extra screenshot files don't exist in memory or on disk");
         mainWindow.webContents.send(this.deps.PROCESSING_EVENTS.NO_SCREENSHOTS);
         return;
       }
       
-      mainWindow.webContents.send(this.deps.PROCESSING_EVENTS.DEBUG_START)
+      const traceId = tracer.ensureTrace("debug")
+      mainWindow.webContents.send(this.deps.PROCESSING_EVENTS.DEBUG_START, { traceId })
+      const debugSpan = tracer.startSpan("debug screenshots", "processing", {
+        screenshots: existingExtraScreenshots.length
+      })
 
       // Initialize AbortController
       this.currentExtraProcessingAbortController = new AbortController()
@@ -371,28 +664,8 @@ export class ProcessingHelper {
           ...existingExtraScreenshots
         ];
         
-        const screenshots = await Promise.all(
-          allPaths.map(async (path) => {
-            try {
-              if (!fs.existsSync(path)) {
-                console.warn(`Screenshot file does not exist: ${path}`);
-                return null;
-              }
-              
-              return {
-                path,
-                preview: await this.screenshotHelper.getImagePreview(path),
-                data: fs.readFileSync(path).toString('base64')
-              };
-            } catch (err) {
-              console.error(`Error reading screenshot ${path}:`, err);
-              return null;
-            }
-          })
-        )
-        
-        // Filter out any nulls from failed screenshots
-        const validScreenshots = screenshots.filter(Boolean);
+        // Read and optimize screenshots; missing or unreadable files are dropped
+        const validScreenshots = await this.loadScreenshotsForUpload(allPaths);
         
         if (validScreenshots.length === 0) {
           throw new Error("Failed to load screenshot data for debugging");
@@ -403,17 +676,18 @@ export class ProcessingHelper {
           validScreenshots.map((s) => s.path)
         )
 
-        const result = await this.processExtraScreenshotsHelper(
-          validScreenshots,
-          signal
+        const result = await tracer.trace("analyze", "processing", () =>
+          this.processExtraScreenshotsHelper(validScreenshots, signal)
         )
 
         if (result.success) {
           this.deps.setHasDebugged(true)
+          const sendSpan = tracer.startSpan("send debug-success", "ipc")
           mainWindow.webContents.send(
             this.deps.PROCESSING_EVENTS.DEBUG_SUCCESS,
             result.data
           )
+          sendSpan.end()
         } else {
           mainWindow.webContents.send(
             this.deps.PROCESSING_EVENTS.DEBUG_ERROR,
@@ -434,275 +708,360 @@ export class ProcessingHelper {
         }
       } finally {
         this.currentExtraProcessingAbortController = null
+        debugSpan.end()
       }
     }
   }
 
-  private async processScreenshotsHelper(
-    screenshots: Array<{ path: string; data: string }>,
-    signal: AbortSignal
-  ) {
-    try {
-      const config = configHelper.loadConfig();
-      const language = await this.getLanguage();
-      const mainWindow = this.deps.getMainWindow();
-      
-      // Step 1: Extract problem info using AI Vision API (OpenAI or Gemini)
-      const imageDataList = screenshots.map(screenshot => screenshot.data);
-      
-      // Update the user on progress
-      if (mainWindow) {
-        mainWindow.webContents.send("processing-status", {
-          message: "Analyzing problem from screenshots...",
-          progress: 20
-        });
-      }
-
-      let problemInfo;
-      
-      if (config.apiProvider === "openai") {
-        // Verify OpenAI client
-        if (!this.openaiClient) {
-          this.initializeAIClient(); // Try to reinitialize
-          
-          if (!this.openaiClient) {
-            return {
-              success: false,
-              error: "OpenAI API key not configured or invalid. Please check your settings."
-            };
-          }
-        }
+  /**
+   * Identify a screenshot set by its ordered file paths
+   */
+  private getScreenshotSignature(screenshots: Array<{ path: string }>): string {
+    return screenshots.map(screenshot => screenshot.path).join("|");
+  }
 
-        // Use OpenAI for processing
-        const messages = [
-          {
-            role: "system" as const, 
-            content: "You are a coding challenge interpreter. Analyze the screenshot of the coding problem and extract all relevant information. Return the information in JSON format with these fields: problem_statement, constraints, example_input, example_output. Just return the structured JSON without any other text."
-          },
-          {
-            role: "user" as const,
-            content: [
-              {
-                type: "text" as const, 
-                text: `Extract the coding problem details from these screenshots. Return in JSON format. Preferred coding language we gonna use for this problem is ${language}.`
-              },
-              ...imageDataList.map(data => ({
-                type: "image_url" as const,
-                image_url: { url: `data:image/png;base64,${data}` }
-              }))
-            ]
-          }
-        ];
+  /**
+   * Start (or restart) problem extraction for the current queue in the background,
+   * so that processing only has to run the solution stage. No-op unless enabled.
+   */
+  public startSpeculativeExtraction(): void {
+    const config = configHelper.getConfig();
+    // A skipped duplicate capture leaves the queue as it was; keep the running extraction
+    const current = this.speculativeExtraction;
+    if (
+      current &&
+      !current.controller.signal.aborted &&
+      current.signature === this.getScreenshotSignature(this.screenshotHelper.getScreenshotQueue().map(path => ({ path })))
+    ) {
+      return;
+    }
+    this.cancelSpeculativeExtraction();
 
-        // Send to OpenAI Vision API
-        const extractionResponse = await this.openaiClient.chat.completions.create({
-          model: config.extractionModel || "gpt-4o",
-          messages: messages,
-          max_tokens: 4000,
-          temperature: 0.2
-        });
+    // One-shot mode extracts and solves in a single request, so there is nothing to start early
+    if (!config.speculativeExtraction || config.oneShotMode || this.deps.getView() !== "queue") return;
+    if (this.currentProcessingAbortController) return; // A real request is already running
 
-        // Parse the response
-        try {
-          const responseText = extractionResponse.choices[0].message.content;
-          // Handle when OpenAI might wrap the JSON in markdown code blocks
-          const jsonText = responseText.replace(/```json|```/g, '').trim();
-          problemInfo = JSON.parse(jsonText);
-        } catch (error) {
-          console.error("Error parsing OpenAI response:", error);
-          return {
-            success: false,
-            error: "Failed to parse problem information. Please try again or use clearer screenshots."
-          };
-        }
-      } else if (config.apiProvider === "gemini")  {
-        // Use Gemini API
-        if (!this.geminiApiKey) {
-          return {
-            success: false,
-            error: "Gemini API key not configured. Please check your settings."
-          };
-        }
+    const queue = this.screenshotHelper.getScreenshotQueue();
+    if (queue.length === 0) return;
 
-        try {
-          // Create Gemini message structure
-          const geminiMessages: GeminiMessage[] = [
-            {
-              role: "user",
-              parts: [
-                {
-                  text: `You are a coding challenge interpreter. Analyze the screenshots of the coding problem and extract all relevant information. Return the information in JSON format with these fields: problem_statement, constraints, example_input, example_output. Just return the structured JSON without any other text. Preferred coding language we gonna use for this problem is ${language}.`
-                },
-                ...imageDataList.map(data => ({
-                  inlineData: {
-                    mimeType: "image/png",
-                    data: data
-                  }
-                }))
-              ]
-            }
-          ];
-
-          // Make API request to Gemini
-          const response = await axios.default.post(
-            `https://generativelanguage.googleapis.com/v1beta/models/${config.extractionModel || "gemini-2.0-flash"}:generateContent?key=${this.geminiApiKey}`,
-            {
-              contents: geminiMessages,
-              generationConfig: {
-                temperature: 0.2,
-                maxOutputTokens: 4000
-              }
-            },
-            { signal }
-          );
+    const controller = new AbortController();
+    const signature = this.getScreenshotSignature(queue.map(path => ({ path })));
+    console.log("Starting speculative extraction for:", queue);
 
-          const responseData = response.data as GeminiResponse;
-          
-          if (!responseData.candidates || responseData.candidates.length === 0) {
-            throw new Error("Empty response from Gemini API");
-          }
-          
-          const responseText = responseData.candidates[0].content.parts[0].text;
-          
-          // Handle when Gemini might wrap the JSON in markdown code blocks
-          const jsonText = responseText.replace(/```json|```/g, '').trim();
-          problemInfo = JSON.parse(jsonText);
-        } catch (error) {
-          console.error("Error using Gemini API:", error);
-          return {
-            success: false,
-            error: "Failed to process with Gemini API. Please check your API key or try again later."
-          };
-        }
-      } else if (config.apiProvider === "anthropic") {
-        if (!this.anthropicClient) {
-          return {
-            success: false,
-            error: "Anthropic API key not configured. Please check your settings."
-          };
+    const promise = (async () => {
+      try {
+        const screenshots = await this.loadScreenshotsForUpload(queue, "speculative");
+        return await tracer.trace("speculative extraction", "speculative", () =>
+          this.extractProblemInfo(screenshots, controller.signal)
+        );
+      } catch (error: any) {
+        if (!controller.signal.aborted) {
+          console.warn("Speculative extraction failed:", error);
         }
+        return { success: false, error: error?.message || "Speculative extraction failed" };
+      }
+    })();
 
-        try {
-          const messages = [
-            {
-              role: "user" as const,
-              content: [
-                {
-                  type: "text" as const,
-                  text: `Extract the coding problem details from these screenshots. Return in JSON format with these fields: problem_statement, constraints, example_input, example_output. Preferred coding language is ${language}.`
-                },
-                ...imageDataList.map(data => ({
-                  type: "image" as const,
-                  source: {
-                    type: "base64" as const,
-                    media_type: "image/png" as const,
-                    data: data
-                  }
-                }))
-              ]
-            }
-          ];
+    this.speculativeExtraction = { signature, controller, promise };
+  }
 
-          const response = await this.anthropicClient.messages.create({
-            model: config.extractionModel || "claude-3-7-sonnet-20250219",
-            max_tokens: 4000,
-            messages: messages,
-            temperature: 0.2
-          });
+  /**
+   * Abort any in-flight speculative extraction
+   */
+  public cancelSpeculativeExtraction(): void {
+    if (this.speculativeExtraction) {
+      this.speculativeExtraction.controller.abort();
+      this.speculativeExtraction = null;
+    }
+  }
 
-          const responseText = (response.content[0] as { type: 'text', text: string }).text;
-          const jsonText = responseText.replace(/```json|```/g, '').trim();
-          problemInfo = JSON.parse(jsonText);
-        } catch (error: any) {
-          console.error("Error using Anthropic API:", error);
-
-          // Add specific handling for Claude's limitations
-          if (error.status === 429) {
-            return {
-              success: false,
-              error: "Claude API rate limit exceeded. Please wait a few minutes before trying again."
-            };
-          } else if (error.status === 413 || (error.message && error.message.includes("token"))) {
-            return {
-              success: false,
-              error: "Your screenshots contain too much information for Claude to process. Switch to OpenAI or Gemini in settings which can handle larger inputs."
-            };
-          }
+  /**
+   * Hand over the speculative extraction if it was started for exactly these screenshots.
+   * Returns null (and aborts the stale request) otherwise.
+   */
+  private async takeSpeculativeExtraction(
+    screenshots: Array<{ path: string }>,
+    signal: AbortSignal
+  ): Promise<{ success: boolean; data?: any; error?: string } | null> {
+    const speculative = this.speculativeExtraction;
+    this.speculativeExtraction = null;
+    if (!speculative) return null;
+
+    if (speculative.signature !== this.getScreenshotSignature(screenshots)) {
+      speculative.controller.abort();
+      return null;
+    }
 
-          return {
-            success: false,
-            error: "Failed to process with Anthropic API. Please check your API key or try again later."
-          };
-        }
-      }
-      
-      // Update the user on progress
-      if (mainWindow) {
-        mainWindow.webContents.send("processing-status", {
-          message: "Problem analyzed successfully. Preparing to generate solution...",
-          progress: 40
-        });
-      }
+    console.log("Using speculative extraction started at capture time");
+    // Cancelling the user's request must also cancel the adopted one
+    signal.addEventListener("abort", () => speculative.controller.abort());
+    return speculative.promise;
+  }
 
-      // Store problem info in AppState
-      this.deps.setProblemInfo(problemInfo);
+  /**
+   * Cache key for the provider and model that extract the problem. A hedge
+   * provider's answer is stored under the primary's key, since that is the
+   * configuration that asked for it.
+   */
+  private getExtractor(configuredModel: string): string {
+    const config = configHelper.getConfig();
+    return `${config.apiProvider}:${configuredModel || "default"}`;
+  }
 
-      // Send first success event
-      if (mainWindow) {
-        mainWindow.webContents.send(
-          this.deps.PROCESSING_EVENTS.PROBLEM_EXTRACTED,
-          problemInfo
-        );
+  /**
+   * Extractor the current mode reads screenshots with: the solution model in
+   * one-shot mode, the extraction model otherwise
+   */
+  private getActiveExtractor(): string {
+    const config = configHelper.getConfig();
+    return this.getExtractor(config.oneShotMode ? config.solutionModel : config.extractionModel);
+  }
 
-        // Generate solutions after successful extraction
-        const solutionsResult = await this.generateSolutionsHelper(signal);
-        if (solutionsResult.success) {
-          // Clear any existing extra screenshots before transitioning to solutions view
-          this.screenshotHelper.clearExtraScreenshotQueue();
-          
-          // Final progress update
-          mainWindow.webContents.send("processing-status", {
-            message: "Solution generated successfully",
-            progress: 100
-          });
-          
-          mainWindow.webContents.send(
-            this.deps.PROCESSING_EVENTS.SOLUTION_SUCCESS,
-            solutionsResult.data
-          );
-          return { success: true, data: solutionsResult.data };
-        } else {
-          throw new Error(
-            solutionsResult.error || "Failed to generate solutions"
-          );
-        }
-      }
+  /**
+   * Look up a previous extraction of these screenshots by the same extractor.
+   * The hashes are returned so a fresh extraction can be stored under them.
+   */
+  private async lookupCachedExtraction(
+    screenshots: UploadScreenshot[],
+    extractor: string
+  ): Promise<{ screenshotHashes: string[] | null; cachedProblemInfo: any | null }> {
+    if (!configHelper.getConfig().extractionCacheEnabled) {
+      return { screenshotHashes: null, cachedProblemInfo: null };
+    }
 
-      return { success: false, error: "Failed to process screenshots" };
-    } catch (error: any) {
-      // If the request was cancelled, don't retry
-      if (axios.isCancel(error)) {
-        return {
-          success: false,
-          error: "Processing was canceled by the user."
-        };
+    try {
+      const screenshotHashes = await Promise.all(
+        screenshots.map(screenshot => this.screenshotHelper.getScreenshotHash(screenshot.path))
+      );
+      return { screenshotHashes, cachedProblemInfo: await extractionCache.lookup(extractor, screenshotHashes) };
+    } catch (error) {
+      console.warn("Extraction cache unavailable:", error);
+      return { screenshotHashes: null, cachedProblemInfo: null };
+    }
+  }
+
+  /**
+   * Perceptual hashes of a screenshot set, or null if any cannot be computed
+   */
+  private async hashScreenshots(screenshots: Array<{ path: string }>): Promise<string[] | null> {
+    try {
+      return await Promise.all(
+        screenshots.map(screenshot => this.screenshotHelper.getScreenshotHash(screenshot.path))
+      );
+    } catch (error) {
+      console.warn("Could not hash screenshots:", error);
+      return null;
+    }
+  }
+
+  /**
+   * Problem and solution from an earlier solve of the same screenshots by
+   * the current extractor
+   */
+  private async recallSolveFromHistory(
+    screenshots: UploadScreenshot[],
+    language: string
+  ): Promise<{ problemInfo: any; solution: any } | null> {
+    if (!configHelper.getConfig().historyEnabled) return null;
+    const hashes = await this.hashScreenshots(screenshots);
+    if (!hashes) return null;
+
+    try {
+      const startedAt = Date.now();
+      const recalled = await historyStore.recallByScreenshots(this.getActiveExtractor(), hashes, language);
+      if (!recalled?.solution) return null;
+      console.log(`Answered from history in ${Date.now() - startedAt} ms`);
+      return recalled;
+    } catch (error) {
+      console.warn("Solve history unavailable:", error);
+      return null;
+    }
+  }
+
+  /**
+   * Save a finished solve to history. The solution itself is skipped when it
+   * was served from history.
+   */
+  private async rememberSolve(
+    screenshots: UploadScreenshot[],
+    language: string,
+    solution: any,
+    solutionFromHistory: boolean
+  ): Promise<void> {
+    const problemInfo = this.deps.getProblemInfo();
+    if (!configHelper.getConfig().historyEnabled || !problemInfo) return;
+
+    try {
+      const hashes = await this.hashScreenshots(screenshots);
+      await historyStore.recordExtraction(this.getActiveExtractor(), hashes ?? [], problemInfo);
+      if (!solutionFromHistory) {
+        await historyStore.recordSolution(problemInfo, language, solution);
       }
-      
-      // Handle OpenAI API errors specifically
-      if (error?.response?.status === 401) {
+    } catch (error) {
+      console.warn("Could not save solve to history:", error);
+    }
+  }
+
+  /**
+   * Extract problem info from screenshots using the configured vision model.
+   * Provider errors are returned as { success: false }; transport errors are thrown.
+   */
+  private async extractProblemInfo(
+    screenshots: UploadScreenshot[],
+    signal: AbortSignal
+  ): Promise<{ success: boolean; data?: any; error?: string }> {
+    const config = configHelper.getConfig();
+    const language = this.getLanguage();
+
+    let problemInfo;
+
+    // Reuse an earlier extraction when the same screenshots were seen before
+    const extractor = this.getExtractor(config.extractionModel);
+    const { screenshotHashes, cachedProblemInfo } = await this.lookupCachedExtraction(screenshots, extractor);
+    
+    const requestStartedAt = Date.now();
+    let ocrText: string | null = null;
+    if (cachedProblemInfo) {
+      console.log("Using cached problem extraction");
+      problemInfo = cachedProblemInfo;
+    } else {
+      const provider = this.getProvider();
+      if (!provider) {
         return {
           success: false,
-          error: "Invalid OpenAI API key. Please check your settings."
+          error: `${PROVIDER_DISPLAY_NAMES[config.apiProvider]} API key not configured or invalid. Please check your settings.`
         };
-      } else if (error?.response?.status === 429) {
+      }
+
+      ocrText = await this.recognizeScreenshotText(screenshots, signal);
+      try {
+        const responseText = await this.completeWithHedge("Extraction", (candidate) => ({
+          model: this.getModelFor(candidate, config.extractionModel),
+          systemPrompt: ocrText
+            ? "You are a coding challenge interpreter. Analyze the text of the coding problem and extract all relevant information: the problem statement, constraints, example input and example output."
+            : "You are a coding challenge interpreter. Analyze the screenshots of the coding problem and extract all relevant information: the problem statement, constraints, example input and example output.",
+          prompt: ocrText
+            ? `Extract the coding problem details from this text. It was read from screenshots by OCR, so correct obvious recognition errors. Preferred coding language we gonna use for this problem is ${language}.\n\n${ocrText}`
+            : `Extract the coding problem details from these screenshots. Preferred coding language we gonna use for this problem is ${language}.`,
+          images: ocrText ? undefined : screenshots,
+          maxTokens: 4000,
+          temperature: 0.2,
+          responseSchema: EXTRACTION_RESPONSE
+        }), signal);
+
+        problemInfo = JSON.parse(responseText);
+      } catch (error) {
+        if (signal.aborted) throw error;
+
+        console.error(`Error extracting problem with ${provider.displayName}:`, error);
         return {
           success: false,
-          error: "OpenAI API rate limit exceeded or insufficient credits. Please try again later."
+          error: error instanceof SyntaxError
+            ? "Failed to parse problem information. Please try again or use clearer screenshots."
+            : provider.describeError(error, "process screenshots")
         };
-      } else if (error?.response?.status === 500) {
+      }
+    }
+
+    if (!cachedProblemInfo) {
+      this.logUploadTiming("Extraction", ocrText ?? screenshots, requestStartedAt);
+    }
+
+    if (screenshotHashes && problemInfo && !cachedProblemInfo) {
+      void extractionCache.store(extractor, screenshotHashes, problemInfo);
+    }
+
+    if (!problemInfo) {
+      return { success: false, error: "Failed to extract problem information" };
+    }
+
+    return { success: true, data: problemInfo };
+  }
+
+  private async processScreenshotsHelper(
+    screenshots: UploadScreenshot[],
+    signal: AbortSignal
+  ) {
+    try {
+      const mainWindow = this.deps.getMainWindow();
+      
+      // Update the user on progress
+      if (mainWindow) {
+        mainWindow.webContents.send("processing-status", {
+          message: "Analyzing problem from screenshots...",
+          progress: 20
+        });
+      }
+
+      const language = this.getLanguage();
+      let solutionsResult: { success: boolean; data?: any; error?: string; fromHistory?: boolean };
+      // A problem solved before is answered without any model call
+      const recalled = await this.recallSolveFromHistory(screenshots, language);
+      if (recalled) {
+        this.cancelSpeculativeExtraction();
+        this.publishProblemInfo(recalled.problemInfo);
+        solutionsResult = { success: true, data: recalled.solution, fromHistory: true };
+      } else if (configHelper.getConfig().oneShotMode) {
+        // Problem and solution come back from a single request
+        solutionsResult = await tracer.trace("extract and solve", "processing", () =>
+          this.extractAndSolveHelper(screenshots, signal)
+        );
+      } else {
+        // Step 1: Extract problem info, adopting a matching speculative extraction started at capture time
+        const extractionSpan = tracer.startSpan("extract problem", "processing");
+        let extraction = await this.takeSpeculativeExtraction(screenshots, signal);
+        const adoptedSpeculative = Boolean(extraction?.success);
+        if (!extraction || !extraction.success) {
+          extraction = await this.extractProblemInfo(screenshots, signal);
+        }
+        extractionSpan.end({ speculative: adoptedSpeculative, success: extraction.success });
+        if (!extraction.success) {
+          return { success: false, error: extraction.error };
+        }
+        this.publishProblemInfo(extraction.data);
+
+        // Step 2: Generate solutions after successful extraction
+        solutionsResult = await tracer.trace("generate solution", "processing", () =>
+          this.generateSolutionsHelper(signal)
+        );
+      }
+
+      if (mainWindow) {
+        if (solutionsResult.success) {
+          if (!recalled) {
+            void this.rememberSolve(screenshots, language, solutionsResult.data, !!solutionsResult.fromHistory);
+          }
+
+          // Clear any existing extra screenshots before transitioning to solutions view
+          this.screenshotHelper.clearExtraScreenshotQueue();
+          
+          // Final progress update
+          mainWindow.webContents.send("processing-status", {
+            message: "Solution generated successfully",
+            progress: 100
+          });
+          
+          const sendSpan = tracer.startSpan("send solution-success", "ipc");
+          mainWindow.webContents.send(
+            this.deps.PROCESSING_EVENTS.SOLUTION_SUCCESS,
+            solutionsResult.data
+          );
+          sendSpan.end();
+          return { success: true, data: solutionsResult.data };
+        } else {
+          throw new Error(
+            solutionsResult.error || "Failed to generate solutions"
+          );
+        }
+      }
+
+      return { success: false, error: "Failed to process screenshots" };
+    } catch (error: any) {
+      // If the request was cancelled, don't retry
+      if (axios.isCancel(error) || signal.aborted) {
         return {
           success: false,
-          error: "OpenAI server error. Please try again later."
+          error: "Processing was canceled by the user."
         };
       }
 
@@ -714,17 +1073,187 @@ export class ProcessingHelper {
     }
   }
 
+  /**
+   * Store extracted problem info and tell the renderer about it
+   */
+  private publishProblemInfo(problemInfo: any): void {
+    const mainWindow = this.deps.getMainWindow();
+
+    // Update the user on progress
+    if (mainWindow) {
+      mainWindow.webContents.send("processing-status", {
+        message: "Problem analyzed successfully. Preparing to generate solution...",
+        progress: 40
+      });
+    }
+
+    // Store problem info in AppState
+    this.deps.setProblemInfo(problemInfo);
+
+    if (mainWindow) {
+      mainWindow.webContents.send(
+        this.deps.PROCESSING_EVENTS.PROBLEM_EXTRACTED,
+        problemInfo
+      );
+    }
+  }
+
+  /**
+   * One-shot mode: send the screenshots once and get the problem and its
+   * solution back from the same request. The response is parsed while it
+   * streams, so PROBLEM_EXTRACTED fires as soon as the problem field closes.
+   */
+  private async extractAndSolveHelper(
+    screenshots: UploadScreenshot[],
+    signal: AbortSignal
+  ): Promise<{ success: boolean; data?: any; error?: string }> {
+    const config = configHelper.getConfig();
+    const language = this.getLanguage();
+
+    // A cached extraction leaves only the text-only solution request
+    const extractor = this.getExtractor(config.solutionModel);
+    const { screenshotHashes, cachedProblemInfo } = await this.lookupCachedExtraction(screenshots, extractor);
+    if (cachedProblemInfo) {
+      console.log("Using cached problem extraction");
+      this.publishProblemInfo(cachedProblemInfo);
+      return this.generateSolutionsHelper(signal);
+    }
+
+    const provider = this.getProvider();
+    if (!provider) {
+      return {
+        success: false,
+        error: `${PROVIDER_DISPLAY_NAMES[config.apiProvider]} API key not configured or invalid. Please check your settings.`
+      };
+    }
+
+    const mainWindow = this.deps.getMainWindow();
+    if (mainWindow) {
+      mainWindow.webContents.send("processing-status", {
+        message: "Analyzing problem and generating solution...",
+        progress: 30
+      });
+    }
+
+    const ocrText = await this.recognizeScreenshotText(screenshots, signal);
+
+    let problemInfo: any = null;
+    const parser = new IncrementalJsonParser({
+      onField: (field, value) => {
+        if (field === "problem" && !problemInfo) {
+          problemInfo = value;
+          this.publishProblemInfo(problemInfo);
+        }
+      },
+      onStringDelta: (field, delta) => {
+        if (config.streamSolutions) this.emitSolutionChunk(field, delta);
+      }
+    });
+
+    const requestStartedAt = Date.now();
+    let responseText: string;
+    try {
+      responseText = await this.completeWithHedge("Extract and solve", (candidate) => ({
+        model: this.getModelFor(candidate, config.solutionModel),
+        systemPrompt: `You are an expert coding interview assistant. Read the coding problem in the ${ocrText ? "text" : "screenshots"}, then provide a clear, optimal solution with detailed explanations.`,
+        prompt: `First, extract the problem details from the ${ocrText ? "text below" : "screenshots"}: the problem statement, constraints, example input and example output.${
+          ocrText ? " The text was read from screenshots by OCR, so correct obvious recognition errors." : ""
+        }
+
+Then solve the problem.
+
+LANGUAGE: ${language}
+
+${this.getSolutionFormatInstructions(language)}${ocrText ? `\n\nPROBLEM TEXT:\n${ocrText}` : ""}`,
+        images: ocrText ? undefined : screenshots,
+        maxTokens: 6000,
+        temperature: 0.2,
+        responseSchema: ONE_SHOT_RESPONSE
+      }), signal, (delta) => parser.feed(delta));
+    } catch (error) {
+      if (signal.aborted) throw error;
+
+      console.error(`Error using ${provider.displayName} API for extract and solve:`, error);
+      return {
+        success: false,
+        error: provider.describeError(error, "process screenshots")
+      };
+    }
+    this.logUploadTiming("Extract and solve", ocrText ?? screenshots, requestStartedAt);
+
+    // A truncated response may still have delivered the problem while streaming
+    let response: any = null;
+    try {
+      response = JSON.parse(responseText);
+    } catch (error) {
+      console.error(`Error parsing ${provider.displayName} extract and solve response:`, error);
+    }
+
+    if (!problemInfo) {
+      if (!response?.problem) {
+        return {
+          success: false,
+          error: "Failed to parse problem information. Please try again or use clearer screenshots."
+        };
+      }
+      problemInfo = response.problem;
+      this.publishProblemInfo(problemInfo);
+    }
+
+    // Cached even when the solution is unusable, so a retry only needs the solution request
+    if (screenshotHashes) {
+      void extractionCache.store(extractor, screenshotHashes, problemInfo);
+    }
+
+    if (!response) {
+      return { success: false, error: "Failed to parse the solution. Please try again." };
+    }
+    try {
+      return { success: true, data: this.formatSolution(response) };
+    } catch (error: any) {
+      console.error("Solution formatting error:", error);
+      return { success: false, error: error.message || "Failed to generate solution" };
+    }
+  }
+
+  /**
+   * Response format shared by the solution and one-shot prompts
+   */
+  private getSolutionFormatInstructions(language: string): string {
+    return `Fill in the response fields as follows:
+- code: A clean, optimized implementation in ${language}
+- thoughts: A list of key insights and reasoning behind your approach
+- time_complexity: O(X) with a detailed explanation (at least 2 sentences)
+- space_complexity: O(X) with a detailed explanation (at least 2 sentences)
+
+For complexity explanations, please be thorough. For example: "Time complexity: O(n) because we iterate through the array only once. This is optimal as we need to examine each element at least once to find the solution." or "Space complexity: O(n) because in the worst case, we store all elements in the hashmap. The additional space scales linearly with the input size."
+
+Your solution should be efficient, well-commented, and handle edge cases.`;
+  }
+
   private async generateSolutionsHelper(signal: AbortSignal) {
     try {
       const problemInfo = this.deps.getProblemInfo();
-      const language = await this.getLanguage();
-      const config = configHelper.loadConfig();
+      const language = this.getLanguage();
+      const config = configHelper.getConfig();
       const mainWindow = this.deps.getMainWindow();
 
       if (!problemInfo) {
         throw new Error("No problem info available");
       }
 
+      // The same problem may have been solved before from other screenshots
+      if (config.historyEnabled) {
+        const remembered = await historyStore.recallSolution(problemInfo, language).catch((error) => {
+          console.warn("Solve history unavailable:", error);
+          return null;
+        });
+        if (remembered) {
+          console.log("Using solution from history");
+          return { success: true, data: remembered, fromHistory: true };
+        }
+      }
+
       // Update progress status
       if (mainWindow) {
         mainWindow.webContents.send("processing-status", {
@@ -751,229 +1280,63 @@ ${problemInfo.example_output || "No example output provided."}
 
 LANGUAGE: ${language}
 
-I need the response in the following format:
-1. Code: A clean, optimized implementation in ${language}
-2. Your Thoughts: A list of key insights and reasoning behind your approach
-3. Time complexity: O(X) with a detailed explanation (at least 2 sentences)
-4. Space complexity: O(X) with a detailed explanation (at least 2 sentences)
-
-For complexity explanations, please be thorough. For example: "Time complexity: O(n) because we iterate through the array only once. This is optimal as we need to examine each element at least once to find the solution." or "Space complexity: O(n) because in the worst case, we store all elements in the hashmap. The additional space scales linearly with the input size."
-
-Your solution should be efficient, well-commented, and handle edge cases.
+${this.getSolutionFormatInstructions(language)}
 `;
 
-      let responseContent;
-      
-      if (config.apiProvider === "openai") {
-        // OpenAI processing
-        if (!this.openaiClient) {
-          return {
-            success: false,
-            error: "OpenAI API key not configured. Please check your settings."
-          };
-        }
-        
-        // Send to OpenAI API
-        const solutionResponse = await this.openaiClient.chat.completions.create({
-          model: config.solutionModel || "gpt-4o",
-          messages: [
-            { role: "system", content: "You are an expert coding interview assistant. Provide clear, optimal solutions with detailed explanations." },
-            { role: "user", content: promptText }
-          ],
-          max_tokens: 4000,
-          temperature: 0.2
-        });
-
-        responseContent = solutionResponse.choices[0].message.content;
-      } else if (config.apiProvider === "gemini")  {
-        // Gemini processing
-        if (!this.geminiApiKey) {
-          return {
-            success: false,
-            error: "Gemini API key not configured. Please check your settings."
-          };
-        }
-        
-        try {
-          // Create Gemini message structure
-          const geminiMessages = [
-            {
-              role: "user",
-              parts: [
-                {
-                  text: `You are an expert coding interview assistant. Provide a clear, optimal solution with detailed explanations for this problem:\n\n${promptText}`
-                }
-              ]
-            }
-          ];
-
-          // Make API request to Gemini
-          const response = await axios.default.post(
-            `https://generativelanguage.googleapis.com/v1beta/models/${config.solutionModel || "gemini-2.0-flash"}:generateContent?key=${this.geminiApiKey}`,
-            {
-              contents: geminiMessages,
-              generationConfig: {
-                temperature: 0.2,
-                maxOutputTokens: 4000
-              }
-            },
-            { signal }
-          );
-
-          const responseData = response.data as GeminiResponse;
-          
-          if (!responseData.candidates || responseData.candidates.length === 0) {
-            throw new Error("Empty response from Gemini API");
-          }
-          
-          responseContent = responseData.candidates[0].content.parts[0].text;
-        } catch (error) {
-          console.error("Error using Gemini API for solution:", error);
-          return {
-            success: false,
-            error: "Failed to generate solution with Gemini API. Please check your API key or try again later."
-          };
-        }
-      } else if (config.apiProvider === "anthropic") {
-        // Anthropic processing
-        if (!this.anthropicClient) {
-          return {
-            success: false,
-            error: "Anthropic API key not configured. Please check your settings."
-          };
-        }
-        
-        try {
-          const messages = [
-            {
-              role: "user" as const,
-              content: [
-                {
-                  type: "text" as const,
-                  text: `You are an expert coding interview assistant. Provide a clear, optimal solution with detailed explanations for this problem:\n\n${promptText}`
-                }
-              ]
-            }
-          ];
-
-          // Send to Anthropic API
-          const response = await this.anthropicClient.messages.create({
-            model: config.solutionModel || "claude-3-7-sonnet-20250219",
-            max_tokens: 4000,
-            messages: messages,
-            temperature: 0.2
-          });
-
-          responseContent = (response.content[0] as { type: 'text', text: string }).text;
-        } catch (error: any) {
-          console.error("Error using Anthropic API for solution:", error);
-
-          // Add specific handling for Claude's limitations
-          if (error.status === 429) {
-            return {
-              success: false,
-              error: "Claude API rate limit exceeded. Please wait a few minutes before trying again."
-            };
-          } else if (error.status === 413 || (error.message && error.message.includes("token"))) {
-            return {
-              success: false,
-              error: "Your screenshots contain too much information for Claude to process. Switch to OpenAI or Gemini in settings which can handle larger inputs."
-            };
-          }
-
-          return {
-            success: false,
-            error: "Failed to generate solution with Anthropic API. Please check your API key or try again later."
-          };
-        }
-      }
-      
-      // Extract parts from the response
-      const codeMatch = responseContent.match(/```(?:\w+)?\s*([\s\S]*?)```/);
-      const code = codeMatch ? codeMatch[1].trim() : responseContent;
-      
-      // Extract thoughts, looking for bullet points or numbered lists
-      const thoughtsRegex = /(?:Thoughts:|Key Insights:|Reasoning:|Approach:)([\s\S]*?)(?:Time complexity:|$)/i;
-      const thoughtsMatch = responseContent.match(thoughtsRegex);
-      let thoughts: string[] = [];
-      
-      if (thoughtsMatch && thoughtsMatch[1]) {
-        // Extract bullet points or numbered items
-        const bulletPoints = thoughtsMatch[1].match(/(?:^|\n)\s*(?:[-*•]|\d+\.)\s*(.*)/g);
-        if (bulletPoints) {
-          thoughts = bulletPoints.map(point => 
-            point.replace(/^\s*(?:[-*•]|\d+\.)\s*/, '').trim()
-          ).filter(Boolean);
-        } else {
-          // If no bullet points found, split by newlines and filter empty lines
-          thoughts = thoughtsMatch[1].split('\n')
-            .map((line) => line.trim())
-            .filter(Boolean);
-        }
-      }
-      
-      // Extract complexity information
-      const timeComplexityPattern = /Time complexity:?\s*([^\n]+(?:\n[^\n]+)*?)(?=\n\s*(?:Space complexity|$))/i;
-      const spaceComplexityPattern = /Space complexity:?\s*([^\n]+(?:\n[^\n]+)*?)(?=\n\s*(?:[A-Z]|$))/i;
-      
-      let timeComplexity = "O(n) - Linear time complexity because we only iterate through the array once. Each element is processed exactly one time, and the hashmap lookups are O(1) operations.";
-      let spaceComplexity = "O(n) - Linear space complexity because we store elements in the hashmap. In the worst case, we might need to store all elements before finding the solution pair.";
-      
-      const timeMatch = responseContent.match(timeComplexityPattern);
-      if (timeMatch && timeMatch[1]) {
-        timeComplexity = timeMatch[1].trim();
-        if (!timeComplexity.match(/O\([^)]+\)/i)) {
-          timeComplexity = `O(n) - ${timeComplexity}`;
-        } else if (!timeComplexity.includes('-') && !timeComplexity.includes('because')) {
-          const notationMatch = timeComplexity.match(/O\([^)]+\)/i);
-          if (notationMatch) {
-            const notation = notationMatch[0];
-            const rest = timeComplexity.replace(notation, '').trim();
-            timeComplexity = `${notation} - ${rest}`;
-          }
-        }
-      }
-      
-      const spaceMatch = responseContent.match(spaceComplexityPattern);
-      if (spaceMatch && spaceMatch[1]) {
-        spaceComplexity = spaceMatch[1].trim();
-        if (!spaceComplexity.match(/O\([^)]+\)/i)) {
-          spaceComplexity = `O(n) - ${spaceComplexity}`;
-        } else if (!spaceComplexity.includes('-') && !spaceComplexity.includes('because')) {
-          const notationMatch = spaceComplexity.match(/O\([^)]+\)/i);
-          if (notationMatch) {
-            const notation = notationMatch[0];
-            const rest = spaceComplexity.replace(notation, '').trim();
-            spaceComplexity = `${notation} - ${rest}`;
-          }
-        }
+      const provider = this.getProvider();
+      if (!provider) {
+        return {
+          success: false,
+          error: `${PROVIDER_DISPLAY_NAMES[config.apiProvider]} API key not configured. Please check your settings.`
+        };
       }
 
-      const formattedResponse = {
-        code: code,
-        thoughts: thoughts.length > 0 ? thoughts : ["Solution approach based on efficiency and readability"],
-        time_complexity: timeComplexity,
-        space_complexity: spaceComplexity
-      };
+      // Surface each field to the renderer as soon as it decodes
+      const parser = new IncrementalJsonParser({
+        onStringDelta: (field, delta) => this.emitSolutionChunk(field, delta)
+      });
 
-      return { success: true, data: formattedResponse };
-    } catch (error: any) {
-      if (axios.isCancel(error)) {
+      let responseContent: string;
+      try {
+        responseContent = await this.completeWithHedge(
+          "Solution",
+          (candidate) => ({
+            model: this.getModelFor(candidate, config.solutionModel),
+            systemPrompt: "You are an expert coding interview assistant. Provide clear, optimal solutions with detailed explanations.",
+            prompt: promptText,
+            maxTokens: 4000,
+            temperature: 0.2,
+            responseSchema: SOLUTION_RESPONSE
+          }),
+          signal,
+          // Stream tokens so the renderer can show code before generation finishes
+          config.streamSolutions ? (delta) => parser.feed(delta) : undefined
+        );
+      } catch (error) {
+        if (signal.aborted) throw error;
+
+        console.error(`Error using ${provider.displayName} API for solution:`, error);
         return {
           success: false,
-          error: "Processing was canceled by the user."
+          error: provider.describeError(error, "generate solution")
         };
       }
       
-      if (error?.response?.status === 401) {
-        return {
-          success: false,
-          error: "Invalid OpenAI API key. Please check your settings."
-        };
-      } else if (error?.response?.status === 429) {
+      // A truncated or non-conforming response is a parse failure, not a crash
+      const parseSpan = tracer.startSpan("parse solution", "processing");
+      try {
+        return { success: true, data: this.formatSolution(JSON.parse(responseContent)) };
+      } catch (error) {
+        console.error(`Error parsing ${provider.displayName} solution response:`, error);
+        return { success: false, error: "Failed to parse the solution. Please try again." };
+      } finally {
+        parseSpan.end();
+      }
+    } catch (error: any) {
+      if (axios.isCancel(error) || signal.aborted) {
         return {
           success: false,
-          error: "OpenAI API rate limit exceeded or insufficient credits. Please try again later."
+          error: "Processing was canceled by the user."
         };
       }
       
@@ -982,14 +1345,48 @@ Your solution should be efficient, well-commented, and handle edge cases.
     }
   }
 
+  /**
+   * Shape a structured solution response for the renderer
+   */
+  private formatSolution(solution: any) {
+    if (!solution || typeof solution.code !== "string" || !solution.code.trim()) {
+      throw new Error("Solution response did not include any code");
+    }
+
+    const thoughts: string[] = Array.isArray(solution.thoughts)
+      ? solution.thoughts.map((thought: unknown) => String(thought).trim()).filter(Boolean)
+      : [];
+
+    return {
+      // Models occasionally fence the code even inside a JSON string
+      code: solution.code.replace(/^\s*```[\w+-]*\n?|\n?```\s*$/g, "").trim(),
+      thoughts: thoughts.length > 0 ? thoughts : ["Solution approach based on efficiency and readability"],
+      time_complexity: String(solution.time_complexity || "").trim(),
+      space_complexity: String(solution.space_complexity || "").trim()
+    };
+  }
+
+  /**
+   * Forward a partial solution token to the renderer
+   */
+  private emitSolutionChunk(field: string, delta: string): void {
+    const mainWindow = this.deps.getMainWindow();
+    if (mainWindow && !mainWindow.isDestroyed()) {
+      mainWindow.webContents.send(
+        this.deps.PROCESSING_EVENTS.SOLUTION_CHUNK,
+        { field, delta }
+      );
+    }
+  }
+
   private async processExtraScreenshotsHelper(
-    screenshots: Array<{ path: string; data: string }>,
+    screenshots: UploadScreenshot[],
     signal: AbortSignal
   ) {
     try {
       const problemInfo = this.deps.getProblemInfo();
-      const language = await this.getLanguage();
-      const config = configHelper.loadConfig();
+      const language = this.getLanguage();
+      const config = configHelper.getConfig();
       const mainWindow = this.deps.getMainWindow();
 
       if (!problemInfo) {
@@ -1004,23 +1401,40 @@ Your solution should be efficient, well-commented, and handle edge cases.
         });
       }
 
-      // Prepare the images for the API call
-      const imageDataList = screenshots.map(screenshot => screenshot.data);
-      
-      let debugContent;
-      
-      if (config.apiProvider === "openai") {
-        if (!this.openaiClient) {
-          return {
-            success: false,
-            error: "OpenAI API key not configured. Please check your settings."
-          };
+      // The same code and errors may have been debugged before
+      const debugHashes = config.historyEnabled ? await this.hashScreenshots(screenshots) : null;
+      if (debugHashes) {
+        const remembered = await historyStore.recallDebug(problemInfo, language, debugHashes).catch((error) => {
+          console.warn("Solve history unavailable:", error);
+          return null;
+        });
+        if (remembered) {
+          console.log("Using debug analysis from history");
+          return { success: true, data: remembered };
         }
-        
-        const messages = [
-          {
-            role: "system" as const, 
-            content: `You are a coding interview assistant helping debug and improve solutions. Analyze these screenshots which include either error messages, incorrect outputs, or test cases, and provide detailed debugging help.
+      }
+
+      const provider = this.getProvider();
+      if (!provider) {
+        return {
+          success: false,
+          error: `${PROVIDER_DISPLAY_NAMES[config.apiProvider]} API key not configured. Please check your settings.`
+        };
+      }
+
+      if (mainWindow) {
+        mainWindow.webContents.send("processing-status", {
+          message: `Analyzing code and generating debug feedback with ${provider.displayName}...`,
+          progress: 60
+        });
+      }
+
+      let debugContent: string;
+      const requestStartedAt = Date.now();
+      try {
+        debugContent = await provider.complete({
+          model: config.debuggingModel || provider.defaultModel,
+          systemPrompt: `You are a coding interview assistant helping debug and improve solutions. Analyze these screenshots which include either error messages, incorrect outputs, or test cases, and provide detailed debugging help.
 
 Your response MUST follow this exact structure with these section headers (use ### for headers):
 ### Issues Identified
@@ -1038,214 +1452,28 @@ Here provide a clear explanation of why the changes are needed
 ### Key Points
 - Summary bullet points of the most important takeaways
 
-If you include code examples, use proper markdown code blocks with language specification (e.g. \`\`\`java).`
-          },
-          {
-            role: "user" as const,
-            content: [
-              {
-                type: "text" as const, 
-                text: `I'm solving this coding problem: "${problemInfo.problem_statement}" in ${language}. I need help with debugging or improving my solution. Here are screenshots of my code, the errors or test cases. Please provide a detailed analysis with:
+If you include code examples, use proper markdown code blocks with language specification (e.g. \`\`\`java).`,
+          prompt: `I'm solving this coding problem: "${problemInfo.problem_statement}" in ${language}. I need help with debugging or improving my solution. Here are screenshots of my code, the errors or test cases. Please provide a detailed analysis with:
 1. What issues you found in my code
 2. Specific improvements and corrections
 3. Any optimizations that would make the solution better
-4. A clear explanation of the changes needed` 
-              },
-              ...imageDataList.map(data => ({
-                type: "image_url" as const,
-                image_url: { url: `data:image/png;base64,${data}` }
-              }))
-            ]
-          }
-        ];
-
-        if (mainWindow) {
-          mainWindow.webContents.send("processing-status", {
-            message: "Analyzing code and generating debug feedback...",
-            progress: 60
-          });
-        }
-
-        const debugResponse = await this.openaiClient.chat.completions.create({
-          model: config.debuggingModel || "gpt-4o",
-          messages: messages,
-          max_tokens: 4000,
-          temperature: 0.2
+4. A clear explanation of the changes needed`,
+          images: screenshots,
+          maxTokens: 4000,
+          temperature: 0.2,
+          signal
         });
-        
-        debugContent = debugResponse.choices[0].message.content;
-      } else if (config.apiProvider === "gemini")  {
-        if (!this.geminiApiKey) {
-          return {
-            success: false,
-            error: "Gemini API key not configured. Please check your settings."
-          };
-        }
-        
-        try {
-          const debugPrompt = `
-You are a coding interview assistant helping debug and improve solutions. Analyze these screenshots which include either error messages, incorrect outputs, or test cases, and provide detailed debugging help.
-
-I'm solving this coding problem: "${problemInfo.problem_statement}" in ${language}. I need help with debugging or improving my solution.
-
-YOUR RESPONSE MUST FOLLOW THIS EXACT STRUCTURE WITH THESE SECTION HEADERS:
-### Issues Identified
-- List each issue as a bullet point with clear explanation
-
-### Specific Improvements and Corrections
-- List specific code changes needed as bullet points
-
-### Optimizations
-- List any performance optimizations if applicable
-
-### Explanation of Changes Needed
-Here provide a clear explanation of why the changes are needed
-
-### Key Points
-- Summary bullet points of the most important takeaways
-
-If you include code examples, use proper markdown code blocks with language specification (e.g. \`\`\`java).
-`;
-
-          const geminiMessages = [
-            {
-              role: "user",
-              parts: [
-                { text: debugPrompt },
-                ...imageDataList.map(data => ({
-                  inlineData: {
-                    mimeType: "image/png",
-                    data: data
-                  }
-                }))
-              ]
-            }
-          ];
-
-          if (mainWindow) {
-            mainWindow.webContents.send("processing-status", {
-              message: "Analyzing code and generating debug feedback with Gemini...",
-              progress: 60
-            });
-          }
-
-          const response = await axios.default.post(
-            `https://generativelanguage.googleapis.com/v1beta/models/${config.debuggingModel || "gemini-2.0-flash"}:generateContent?key=${this.geminiApiKey}`,
-            {
-              contents: geminiMessages,
-              generationConfig: {
-                temperature: 0.2,
-                maxOutputTokens: 4000
-              }
-            },
-            { signal }
-          );
-
-          const responseData = response.data as GeminiResponse;
-          
-          if (!responseData.candidates || responseData.candidates.length === 0) {
-            throw new Error("Empty response from Gemini API");
-          }
-          
-          debugContent = responseData.candidates[0].content.parts[0].text;
-        } catch (error) {
-          console.error("Error using Gemini API for debugging:", error);
-          return {
-            success: false,
-            error: "Failed to process debug request with Gemini API. Please check your API key or try again later."
-          };
-        }
-      } else if (config.apiProvider === "anthropic") {
-        if (!this.anthropicClient) {
-          return {
-            success: false,
-            error: "Anthropic API key not configured. Please check your settings."
-          };
-        }
-        
-        try {
-          const debugPrompt = `
-You are a coding interview assistant helping debug and improve solutions. Analyze these screenshots which include either error messages, incorrect outputs, or test cases, and provide detailed debugging help.
-
-I'm solving this coding problem: "${problemInfo.problem_statement}" in ${language}. I need help with debugging or improving my solution.
-
-YOUR RESPONSE MUST FOLLOW THIS EXACT STRUCTURE WITH THESE SECTION HEADERS:
-### Issues Identified
-- List each issue as a bullet point with clear explanation
-
-### Specific Improvements and Corrections
-- List specific code changes needed as bullet points
-
-### Optimizations
-- List any performance optimizations if applicable
-
-### Explanation of Changes Needed
-Here provide a clear explanation of why the changes are needed
-
-### Key Points
-- Summary bullet points of the most important takeaways
-
-If you include code examples, use proper markdown code blocks with language specification.
-`;
-
-          const messages = [
-            {
-              role: "user" as const,
-              content: [
-                {
-                  type: "text" as const,
-                  text: debugPrompt
-                },
-                ...imageDataList.map(data => ({
-                  type: "image" as const,
-                  source: {
-                    type: "base64" as const,
-                    media_type: "image/png" as const, 
-                    data: data
-                  }
-                }))
-              ]
-            }
-          ];
-
-          if (mainWindow) {
-            mainWindow.webContents.send("processing-status", {
-              message: "Analyzing code and generating debug feedback with Claude...",
-              progress: 60
-            });
-          }
+      } catch (error) {
+        if (signal.aborted) throw error;
 
-          const response = await this.anthropicClient.messages.create({
-            model: config.debuggingModel || "claude-3-7-sonnet-20250219",
-            max_tokens: 4000,
-            messages: messages,
-            temperature: 0.2
-          });
-          
-          debugContent = (response.content[0] as { type: 'text', text: string }).text;
-        } catch (error: any) {
-          console.error("Error using Anthropic API for debugging:", error);
-          
-          // Add specific handling for Claude's limitations
-          if (error.status === 429) {
-            return {
-              success: false,
-              error: "Claude API rate limit exceeded. Please wait a few minutes before trying again."
-            };
-          } else if (error.status === 413 || (error.message && error.message.includes("token"))) {
-            return {
-              success: false,
-              error: "Your screenshots contain too much information for Claude to process. Switch to OpenAI or Gemini in settings which can handle larger inputs."
-            };
-          }
-          
-          return {
-            success: false,
-            error: "Failed to process debug request with Anthropic API. Please check your API key or try again later."
-          };
-        }
+        console.error(`Error using ${provider.displayName} API for debugging:`, error);
+        return {
+          success: false,
+          error: provider.describeError(error, "process debug request")
+        };
       }
-      
+
+      this.logUploadTiming("Debug", screenshots, requestStartedAt);
       
       if (mainWindow) {
         mainWindow.webContents.send("processing-status", {
@@ -1283,8 +1511,21 @@ If you include code examples, use proper markdown code blocks with language spec
         space_complexity: "N/A - Debug mode"
       };
 
+      if (debugHashes) {
+        historyStore.recordDebug(problemInfo, language, debugHashes, response).catch((error) => {
+          console.warn("Could not save debug analysis to history:", error);
+        });
+      }
+
       return { success: true, data: response };
     } catch (error: any) {
+      if (axios.isCancel(error) || signal.aborted) {
+        return {
+          success: false,
+          error: "Processing was canceled by the user."
+        };
+      }
+
       console.error("Debug processing error:", error);
       return { success: false, error: error.message || "Failed to process debug request" };
     }
@@ -1293,6 +1534,8 @@ If you include code examples, use proper markdown code blocks with language spec
   public cancelOngoingRequests(): void {
     let wasCancelled = false
 
+    this.cancelSpeculativeExtraction()
+
     if (this.currentProcessingAbortController) {
       this.currentProcessingAbortController.abort()
       this.currentProcessingAbortController = null
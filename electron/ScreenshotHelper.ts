@@ -2,27 +2,87 @@
 
 import path from "node:path"
 import fs from "node:fs"
-import { app } from "electron"
+import { app, desktopCapturer, Display, NativeImage, screen } from "electron"
 import { v4 as uuidv4 } from "uuid"
 import { execFile } from "child_process"
 import { promisify } from "util"
 import screenshot from "screenshot-desktop"
 import os from "os"
+import { EventEmitter } from "events"
+import { hammingDistance } from "./imageHash"
+import {
+  decodeImage,
+  ImageOptimizationOptions,
+  OptimizedImage,
+  optimizeImage,
+  toPixels
+} from "./ImageOptimizer"
+import { imageWorkerPool } from "./ImageWorkerPool"
+import { tracer } from "./Tracer"
+import { CONTENT_ANALYSIS_WIDTH, ContentCrop, RelativeCrop, toRelativeCrop } from "./ContentCropper"
+import { CaptureMode, CaptureRegion, configHelper } from "./ConfigHelper"
 
 const execFileAsync = promisify(execFile)
 
-export class ScreenshotHelper {
+// Custom scheme the renderer loads screenshot assets from, e.g.
+// ic-asset://thumbnail/<id> or ic-asset://screenshot/<id>
+export const ASSET_PROTOCOL = "ic-asset"
+export type ScreenshotAssetKind = "screenshot" | "thumbnail"
+
+interface BufferedScreenshot {
+  buffer: Buffer                 // Captured PNG
+  base64?: string                // PNG as base64 for unoptimized uploads
+  upload?: { key: string; image: OptimizedImage }  // Last optimized upload encoding
+  written: boolean               // Whether the write-behind to disk has finished
+  persisted: Promise<void>
+}
+
+// Emitted as "duplicate" when a capture matches a screenshot already queued
+export interface DuplicateScreenshotEvent {
+  action: "replace" | "skip"
+  path: string            // The queued screenshot after handling the duplicate
+  replacedPath?: string   // The earlier capture that was dropped, for "replace"
+  distance: number        // Differing hash bits
+}
+
+export class ScreenshotHelper extends EventEmitter {
   private screenshotQueue: string[] = []
   private extraScreenshotQueue: string[] = []
   private readonly MAX_SCREENSHOTS = 5
+  // 256-bit perceptual hash of each queued screenshot, keyed by file path.
+  // Repeat-capture detection and the extraction cache both rely on it, and
+  // neither may confuse two screens that share a layout (the same page
+  // scrolled, say), which a 64-bit hash does.
+  private screenshotHashes = new Map<string, string>()
+  private readonly HASH_SIZE = 16
+  // Captured images kept in memory so previews and uploads never touch the
+  // disk; files are written behind for crash safety and as a fallback
+  private screenshotBuffers = new Map<string, BufferedScreenshot>()
+  private readonly MAX_BUFFERED_BYTES = 64 * 1024 * 1024
+  // Area auto-crop kept for each screenshot's last upload encoding
+  private contentCrops = new Map<string, RelativeCrop>()
+  // Pixels seen by auto-crop versus pixels it kept, across the session
+  private cropStats = { screenshots: 0, cropped: 0, sourcePixels: 0, keptPixels: 0 }
+  // Small JPEG thumbnails for the renderer's preview tiles
+  private screenshotThumbnails = new Map<string, Buffer>()
+  // Twice the 72px tile height so previews stay sharp on HiDPI displays
+  private readonly THUMBNAIL_HEIGHT = 144
+  // Bounds for the wait after hiding the window. The upper bound is the fixed
+  // delay used before hide confirmation existed (Windows needs longer).
+  private readonly HIDE_WAIT_MAX_MS = process.platform === 'win32' ? 500 : 300
+  private readonly HIDE_WAIT_MIN_MS = 50
+  // Moving average of how long the window took to confirm it was hidden
+  private hideLatencyEstimateMs: number | null = null
 
   private readonly screenshotDir: string
   private readonly extraScreenshotDir: string
   private readonly tempDir: string
+  private directoriesReady: Promise<void> | null = null
 
   private view: "queue" | "solutions" | "debug" = "queue"
 
   constructor(view: "queue" | "solutions" | "debug" = "queue") {
+    super()
     this.view = view
 
     // Initialize directories
@@ -33,69 +93,68 @@ export class ScreenshotHelper {
     )
     this.tempDir = path.join(app.getPath("temp"), "interview-coder-screenshots")
 
-    // Create directories if they don't exist
-    this.ensureDirectoriesExist();
-    
-    // Clean existing screenshot directories when starting the app
-    this.cleanScreenshotDirectories();
+    // Directory setup and cleanup of the previous session's files happen in
+    // startHousekeeping, once the window is up
   }
-  
-  private ensureDirectoriesExist(): void {
-    const directories = [this.screenshotDir, this.extraScreenshotDir, this.tempDir];
-    
-    for (const dir of directories) {
-      if (!fs.existsSync(dir)) {
+
+  /**
+   * Create the screenshot directories, once. Anything writing to them awaits this.
+   */
+  private ensureDirectoriesExist(): Promise<void> {
+    if (!this.directoriesReady) {
+      this.directoriesReady = Promise.all(
+        [this.screenshotDir, this.extraScreenshotDir, this.tempDir].map((dir) =>
+          fs.promises.mkdir(dir, { recursive: true }).catch((err) => {
+            console.error(`Error creating directory ${dir}:`, err)
+          })
+        )
+      ).then(() => {})
+    }
+    return this.directoriesReady
+  }
+
+  /**
+   * Startup work kept off the launch path: create the directories and delete
+   * screenshots left over from the previous session, so every session starts
+   * with empty queues. Files captured since launch are left alone.
+   */
+  public async startHousekeeping(): Promise<void> {
+    await this.ensureDirectoriesExist()
+
+    let deleted = 0
+    await Promise.all(
+      [this.screenshotDir, this.extraScreenshotDir].map(async (dir) => {
+        let files: string[]
         try {
-          fs.mkdirSync(dir, { recursive: true });
-          console.log(`Created directory: ${dir}`);
+          files = await fs.promises.readdir(dir)
         } catch (err) {
-          console.error(`Error creating directory ${dir}:`, err);
+          console.error(`Error listing screenshots in ${dir}:`, err)
+          return
         }
-      }
-    }
+
+        await Promise.all(
+          files
+            .filter((file) => file.endsWith(".png"))
+            .map((file) => path.join(dir, file))
+            .filter((file) => !this.screenshotBuffers.has(file) && !this.isQueued(file))
+            .map(async (file) => {
+              try {
+                await fs.promises.unlink(file)
+                deleted++
+              } catch (err: any) {
+                if (err?.code !== "ENOENT") {
+                  console.error(`Error deleting screenshot ${file}:`, err)
+                }
+              }
+            })
+        )
+      })
+    )
+    console.log(`Screenshot directories cleaned, removed ${deleted} leftover file(s)`)
   }
-  
-  // This method replaces loadExistingScreenshots() to ensure we start with empty queues
-  private cleanScreenshotDirectories(): void {
-    try {
-      // Clean main screenshots directory
-      if (fs.existsSync(this.screenshotDir)) {
-        const files = fs.readdirSync(this.screenshotDir)
-          .filter(file => file.endsWith('.png'))
-          .map(file => path.join(this.screenshotDir, file));
-        
-        // Delete each screenshot file
-        for (const file of files) {
-          try {
-            fs.unlinkSync(file);
-            console.log(`Deleted existing screenshot: ${file}`);
-          } catch (err) {
-            console.error(`Error deleting screenshot ${file}:`, err);
-          }
-        }
-      }
-      
-      // Clean extra screenshots directory
-      if (fs.existsSync(this.extraScreenshotDir)) {
-        const files = fs.readdirSync(this.extraScreenshotDir)
-          .filter(file => file.endsWith('.png'))
-          .map(file => path.join(this.extraScreenshotDir, file));
-        
-        // Delete each screenshot file
-        for (const file of files) {
-          try {
-            fs.unlinkSync(file);
-            console.log(`Deleted existing extra screenshot: ${file}`);
-          } catch (err) {
-            console.error(`Error deleting extra screenshot ${file}:`, err);
-          }
-        }
-      }
-      
-      console.log("Screenshot directories cleaned successfully");
-    } catch (err) {
-      console.error("Error cleaning screenshot directories:", err);
-    }
+
+  private isQueued(filepath: string): boolean {
+    return this.screenshotQueue.includes(filepath) || this.extraScreenshotQueue.includes(filepath)
   }
 
   public getView(): "queue" | "solutions" | "debug" {
@@ -125,27 +184,287 @@ export class ScreenshotHelper {
   public clearQueues(): void {
     // Clear screenshotQueue
     this.screenshotQueue.forEach((screenshotPath) => {
-      fs.unlink(screenshotPath, (err) => {
-        if (err)
-          console.error(`Error deleting screenshot at ${screenshotPath}:`, err)
-      })
+      void this.discardScreenshot(screenshotPath)
     })
     this.screenshotQueue = []
 
     // Clear extraScreenshotQueue
     this.extraScreenshotQueue.forEach((screenshotPath) => {
-      fs.unlink(screenshotPath, (err) => {
-        if (err)
-          console.error(
-            `Error deleting extra screenshot at ${screenshotPath}:`,
-            err
-          )
-      })
+      void this.discardScreenshot(screenshotPath)
     })
     this.extraScreenshotQueue = []
   }
 
+  private getBufferedSize(entry: BufferedScreenshot): number {
+    return (
+      entry.buffer.length +
+      (entry.base64?.length || 0) +
+      (entry.upload?.image.data.length || 0)
+    )
+  }
+
+  /**
+   * Drop the oldest in-memory images once the store exceeds its byte budget.
+   * Entries still being written are kept so they can always be read back.
+   */
+  private enforceBufferBudget(): void {
+    let total = 0
+    for (const entry of this.screenshotBuffers.values()) {
+      total += this.getBufferedSize(entry)
+    }
+
+    for (const [filepath, entry] of this.screenshotBuffers) {
+      if (total <= this.MAX_BUFFERED_BYTES) break
+      if (!entry.written) continue
+      total -= this.getBufferedSize(entry)
+      this.screenshotBuffers.delete(filepath)
+      console.log("Released in-memory screenshot, will read from disk:", filepath)
+    }
+  }
+
+  /**
+   * Keep a captured image in memory and persist it to disk in the background
+   */
+  private storeScreenshot(filepath: string, buffer: Buffer): void {
+    const entry: BufferedScreenshot = {
+      buffer,
+      written: false,
+      persisted: Promise.resolve()
+    }
+    const writeSpan = tracer.startSpan("write screenshot", "disk", { bytes: buffer.length })
+    entry.persisted = this.ensureDirectoriesExist()
+      .then(() => fs.promises.writeFile(filepath, buffer))
+      .then(() => {
+        entry.written = true
+      })
+      .catch((error) => {
+        console.error(`Error writing screenshot to ${filepath}:`, error)
+      })
+      .finally(() => writeSpan.end())
+
+    this.screenshotBuffers.set(filepath, entry)
+    this.enforceBufferBudget()
+  }
+
+  /**
+   * Forget a screenshot and remove its file once any pending write has settled
+   */
+  private async discardScreenshot(filepath: string): Promise<void> {
+    const entry = this.screenshotBuffers.get(filepath)
+    this.screenshotBuffers.delete(filepath)
+    this.screenshotHashes.delete(filepath)
+    this.contentCrops.delete(filepath)
+    this.screenshotThumbnails.delete(filepath)
+
+    if (entry) await entry.persisted
+    try {
+      await fs.promises.unlink(filepath)
+    } catch (error: any) {
+      if (error?.code !== "ENOENT") {
+        console.error(`Error deleting screenshot at ${filepath}:`, error)
+      }
+    }
+  }
+
+  /**
+   * Whether a screenshot can still be read, checking memory before the disk
+   */
+  public hasScreenshot(filepath: string): boolean {
+    return this.screenshotBuffers.has(filepath) || fs.existsSync(filepath)
+  }
+
+  /**
+   * Raw PNG bytes of a screenshot, served from memory when available
+   */
+  public async getScreenshotBuffer(filepath: string): Promise<Buffer> {
+    const entry = this.screenshotBuffers.get(filepath)
+    if (entry) return entry.buffer
+    return fs.promises.readFile(filepath)
+  }
+
+  /**
+   * Base64 encoded PNG of a screenshot, encoded at most once while buffered
+   */
+  public async getScreenshotBase64(filepath: string): Promise<string> {
+    const entry = this.screenshotBuffers.get(filepath)
+    if (!entry) {
+      return (await fs.promises.readFile(filepath)).toString("base64")
+    }
+    if (!entry.base64) {
+      entry.base64 = entry.buffer.toString("base64")
+      this.enforceBufferBudget()
+    }
+    return entry.base64
+  }
+
+  /**
+   * PNG of the text-heavy area of a screenshot, for OCR. The full image when
+   * auto-crop is off or finds nothing to remove.
+   */
+  public async getContentImage(filepath: string): Promise<Buffer> {
+    const buffer = await this.getScreenshotBuffer(filepath)
+    if (!configHelper.getConfig().autoCrop) return buffer
+
+    const image = decodeImage(buffer)
+    const crop = await this.detectContent(image)
+    if (!crop) return buffer
+    return image.crop({ x: crop.x, y: crop.y, width: crop.width, height: crop.height }).toPNG()
+  }
+
+  /**
+   * Text-heavy area of a decoded screenshot. The image is downscaled natively
+   * and the detector runs on the image worker pool.
+   */
+  private detectContent(image: NativeImage): Promise<ContentCrop | null> {
+    const source = image.getSize()
+    const analysis =
+      source.width > CONTENT_ANALYSIS_WIDTH
+        ? image.resize({ width: CONTENT_ANALYSIS_WIDTH, quality: "good" })
+        : image
+    return imageWorkerPool.run({
+      kind: "detectContent",
+      bitmap: toPixels(analysis),
+      sourceWidth: source.width,
+      sourceHeight: source.height
+    })
+  }
+
+  /**
+   * Upload encoding of a screenshot, reused across requests with the same options
+   */
+  public async getOptimizedScreenshot(
+    filepath: string,
+    options: ImageOptimizationOptions
+  ): Promise<OptimizedImage> {
+    const key = JSON.stringify(options)
+    const entry = this.screenshotBuffers.get(filepath)
+    if (entry?.upload?.key === key) return entry.upload.image
+
+    const buffer = await this.getScreenshotBuffer(filepath)
+    const optimizeSpan = tracer.startSpan("optimize image", "encode", { format: options.format })
+    const decoded = decodeImage(buffer)
+    const crop = options.autoCrop ? await this.detectContent(decoded) : null
+    const image = await optimizeImage(buffer, decoded, crop, options)
+    optimizeSpan.end({
+      originalBytes: image.originalBytes,
+      optimizedBytes: image.optimizedBytes,
+      cropped: !!image.crop
+    })
+
+    if (options.autoCrop) {
+      this.recordCrop(filepath, image)
+    }
+    if (entry) {
+      entry.upload = { key, image }
+      this.enforceBufferBudget()
+    }
+    return image
+  }
+
+  private recordCrop(filepath: string, image: OptimizedImage): void {
+    const { crop } = image
+    const sourcePixels = crop ? crop.sourceWidth * crop.sourceHeight : image.width * image.height
+    const keptPixels = crop ? crop.width * crop.height : sourcePixels
+
+    this.cropStats.screenshots++
+    this.cropStats.sourcePixels += sourcePixels
+    this.cropStats.keptPixels += keptPixels
+    if (crop) {
+      this.cropStats.cropped++
+      this.contentCrops.set(filepath, toRelativeCrop(crop))
+      console.log(
+        `Auto-crop kept ${crop.width}x${crop.height} of ${crop.sourceWidth}x${crop.sourceHeight} ` +
+        `(${Math.round((1 - keptPixels / sourcePixels) * 100)}% fewer pixels)`
+      )
+    } else {
+      this.contentCrops.delete(filepath)
+    }
+  }
+
+  /**
+   * Area auto-crop kept for a screenshot, as fractions of the full image
+   */
+  public getContentCrop(filepath: string): RelativeCrop | null {
+    return this.contentCrops.get(filepath) ?? null
+  }
+
+  public getCropStats(): {
+    screenshots: number
+    cropped: number
+    sourcePixels: number
+    keptPixels: number
+  } {
+    return { ...this.cropStats }
+  }
+
   private async captureScreenshot(): Promise<Buffer> {
+    const { captureMode, captureRegion } = configHelper.getConfig()
+    if (captureMode === "cursorDisplay" || captureMode === "region") {
+      try {
+        return await this.captureDisplayArea(captureMode, captureRegion)
+      } catch (error) {
+        console.warn("Display capture failed, falling back to the full desktop:", error)
+      }
+    }
+    return this.captureFullDesktop()
+  }
+
+  /**
+   * Capture one display, or the saved region of one, through desktopCapturer.
+   * Falls back to the display under the cursor when the region's display is gone.
+   */
+  private async captureDisplayArea(
+    mode: CaptureMode,
+    region: CaptureRegion | null
+  ): Promise<Buffer> {
+    const regionDisplay =
+      mode === "region" && region
+        ? screen.getAllDisplays().find((display) => display.id === region.displayId)
+        : undefined
+    if (mode === "region" && !regionDisplay) {
+      console.warn("No display for the saved capture region, capturing the display under the cursor")
+    }
+    const display = regionDisplay ?? screen.getDisplayNearestPoint(screen.getCursorScreenPoint())
+
+    let image = await this.captureDisplay(display)
+    if (regionDisplay && region) {
+      // Thumbnail pixels per DIP, normally the display's scale factor
+      const ratio = image.getSize().width / display.size.width
+      const { width: imageWidth, height: imageHeight } = image.getSize()
+      const x = Math.max(0, Math.min(imageWidth - 1, Math.round(region.x * ratio)))
+      const y = Math.max(0, Math.min(imageHeight - 1, Math.round(region.y * ratio)))
+      image = image.crop({
+        x,
+        y,
+        width: Math.max(1, Math.min(imageWidth - x, Math.round(region.width * ratio))),
+        height: Math.max(1, Math.min(imageHeight - y, Math.round(region.height * ratio)))
+      })
+    }
+
+    const buffer = image.toPNG()
+    console.log(`Captured display ${display.id} (${mode}), size: ${buffer.length} bytes`)
+    return buffer
+  }
+
+  private async captureDisplay(display: Display): Promise<NativeImage> {
+    const sources = await desktopCapturer.getSources({
+      types: ["screen"],
+      thumbnailSize: {
+        width: Math.round(display.size.width * display.scaleFactor),
+        height: Math.round(display.size.height * display.scaleFactor)
+      }
+    })
+    // display_id can be empty on some Linux setups; a lone source is still unambiguous
+    const source =
+      sources.find((candidate) => candidate.display_id === String(display.id)) ??
+      (sources.length === 1 ? sources[0] : undefined)
+    if (!source || source.thumbnail.isEmpty()) {
+      throw new Error(`No capture source for display ${display.id}`)
+    }
+    return source.thumbnail
+  }
+
+  private async captureFullDesktop(): Promise<Buffer> {
     try {
       console.log("Starting screenshot capture...");
       
@@ -170,6 +489,7 @@ export class ScreenshotHelper {
    */
   private async captureWindowsScreenshot(): Promise<Buffer> {
     console.log("Attempting Windows screenshot with multiple methods");
+    await this.ensureDirectoriesExist();
     
     // Method 1: Try screenshot-desktop with filename first
     try {
@@ -258,101 +578,303 @@ export class ScreenshotHelper {
     }
   }
 
+  /**
+   * Fallback timeout for hide confirmation, learned from past captures. Until
+   * a hide has been confirmed it stays at the old fixed delay.
+   */
+  private getHideWaitTimeout(): number {
+    if (this.hideLatencyEstimateMs === null) return this.HIDE_WAIT_MAX_MS
+    return Math.min(
+      this.HIDE_WAIT_MAX_MS,
+      Math.max(this.HIDE_WAIT_MIN_MS, Math.ceil(this.hideLatencyEstimateMs * 3))
+    )
+  }
+
+  /**
+   * Wait until the window confirms it is off screen, or until the learned
+   * fallback timeout. Confirmed latencies feed the timeout for later captures.
+   */
+  private async waitForWindowHidden(hidden: Promise<void>): Promise<number> {
+    const timeoutMs = this.getHideWaitTimeout()
+    const startedAt = performance.now()
+
+    let timer: NodeJS.Timeout | null = null
+    const timeout = new Promise<boolean>((resolve) => {
+      timer = setTimeout(() => resolve(false), timeoutMs)
+    })
+    // A failed confirmation falls back to the timeout rather than capturing early
+    const confirmed = await Promise.race([hidden.then(() => true, () => timeout), timeout])
+    clearTimeout(timer)
+
+    const elapsedMs = performance.now() - startedAt
+    if (confirmed) {
+      this.hideLatencyEstimateMs =
+        this.hideLatencyEstimateMs === null
+          ? elapsedMs
+          : this.hideLatencyEstimateMs * 0.8 + elapsedMs * 0.2
+    } else {
+      console.warn(`Window hide not confirmed, continuing after ${timeoutMs} ms fallback`)
+    }
+    return elapsedMs
+  }
+
+  /**
+   * Capture the screen with the app window hidden. hideMainWindow resolves
+   * once the window is off screen; the window is shown again as soon as the
+   * capture is in memory, before hashing, thumbnailing and storage.
+   */
   public async takeScreenshot(
-    hideMainWindow: () => void,
+    hideMainWindow: () => Promise<void>,
     showMainWindow: () => void
   ): Promise<string> {
     console.log("Taking screenshot in view:", this.view)
-    hideMainWindow()
-    
-    // Increased delay for window hiding on Windows
-    const hideDelay = process.platform === 'win32' ? 500 : 300;
-    await new Promise((resolve) => setTimeout(resolve, hideDelay))
+
+    // The first capture of a problem (or of a debug round) starts a new trace
+    const targetQueue = this.view === "queue" ? this.screenshotQueue : this.extraScreenshotQueue
+    if (targetQueue.length === 0) {
+      tracer.beginTrace(this.view === "queue" ? "problem" : "debug")
+    }
+    const screenshotSpan = tracer.startSpan("take screenshot", "capture", { view: this.view })
+
+    let windowShown = false
+    const restoreWindow = () => {
+      if (windowShown) return
+      windowShown = true
+      showMainWindow()
+    }
+
+    const startedAt = performance.now()
+    const hideSpan = tracer.startSpan("wait for hide", "capture", { timeoutMs: this.getHideWaitTimeout() })
+    const hideWaitMs = await this.waitForWindowHidden(hideMainWindow())
+    hideSpan.end()
 
     let screenshotPath = ""
     try {
       // Get screenshot buffer using cross-platform method
+      const captureSpan = tracer.startSpan("capture", "capture")
       const screenshotBuffer = await this.captureScreenshot();
+      captureSpan.end({ bytes: screenshotBuffer?.length || 0 })
+
+      // The pixels are in hand, so the window can come back right away
+      restoreWindow()
+      console.log(
+        `Window hidden for ${Math.round(performance.now() - startedAt)} ms ` +
+        `(hide confirmed in ${Math.round(hideWaitMs)} ms)`
+      )
       
       if (!screenshotBuffer || screenshotBuffer.length === 0) {
         throw new Error("Screenshot capture returned empty buffer");
       }
 
+      // One native decode and downscale serves the thumbnail and the hash;
+      // the hash is computed from the downscaled pixels on a worker thread
+      let screenshotHash: string | null = null
+      let thumbnail: Buffer | null = null
+      const analyzeSpan = tracer.startSpan("hash and thumbnail", "capture")
+      try {
+        const small = this.createThumbnail(decodeImage(screenshotBuffer))
+        thumbnail = small.toJPEG(80)
+        screenshotHash = await imageWorkerPool.run({
+          kind: "hash",
+          bitmap: toPixels(small),
+          size: this.HASH_SIZE
+        })
+      } catch (analyzeError) {
+        console.warn("Could not hash the screenshot or create its thumbnail:", analyzeError)
+      }
+      analyzeSpan.end()
+
+      // Repeat captures of the same screen would only take up a slot and be uploaded twice
+      const { duplicateScreenshots, duplicateHashDistance } = configHelper.getConfig()
+      const duplicate = screenshotHash && duplicateScreenshots !== "keep"
+        ? this.findDuplicate(targetQueue, screenshotHash, duplicateHashDistance)
+        : null
+
+      if (duplicate && duplicateScreenshots === "skip") {
+        console.log(`Skipping duplicate capture of ${duplicate.path} (distance ${duplicate.distance})`)
+        screenshotPath = duplicate.path
+        this.emit("duplicate", {
+          action: "skip",
+          path: duplicate.path,
+          distance: duplicate.distance
+        } as DuplicateScreenshotEvent)
+        return screenshotPath
+      }
+      const replacedPath = duplicate?.path ?? null
+
       // Save and manage the screenshot based on current view
       if (this.view === "queue") {
         screenshotPath = path.join(this.screenshotDir, `${uuidv4()}.png`)
-        await fs.promises.writeFile(screenshotPath, screenshotBuffer)
+        this.storeScreenshot(screenshotPath, screenshotBuffer)
         console.log("Adding screenshot to main queue:", screenshotPath)
-        this.screenshotQueue.push(screenshotPath)
+        if (thumbnail) this.screenshotThumbnails.set(screenshotPath, thumbnail)
+        this.enqueue(this.screenshotQueue, screenshotPath, replacedPath)
+        if (screenshotHash) this.screenshotHashes.set(screenshotPath, screenshotHash)
         if (this.screenshotQueue.length > this.MAX_SCREENSHOTS) {
           const removedPath = this.screenshotQueue.shift()
           if (removedPath) {
-            try {
-              await fs.promises.unlink(removedPath)
-              console.log(
-                "Removed old screenshot from main queue:",
-                removedPath
-              )
-            } catch (error) {
-              console.error("Error removing old screenshot:", error)
-            }
+            void this.discardScreenshot(removedPath)
+            console.log(
+              "Removed old screenshot from main queue:",
+              removedPath
+            )
           }
         }
       } else {
         // In solutions view, only add to extra queue
         screenshotPath = path.join(this.extraScreenshotDir, `${uuidv4()}.png`)
-        await fs.promises.writeFile(screenshotPath, screenshotBuffer)
+        this.storeScreenshot(screenshotPath, screenshotBuffer)
         console.log("Adding screenshot to extra queue:", screenshotPath)
-        this.extraScreenshotQueue.push(screenshotPath)
+        if (thumbnail) this.screenshotThumbnails.set(screenshotPath, thumbnail)
+        this.enqueue(this.extraScreenshotQueue, screenshotPath, replacedPath)
+        if (screenshotHash) this.screenshotHashes.set(screenshotPath, screenshotHash)
         if (this.extraScreenshotQueue.length > this.MAX_SCREENSHOTS) {
           const removedPath = this.extraScreenshotQueue.shift()
           if (removedPath) {
-            try {
-              await fs.promises.unlink(removedPath)
-              console.log(
-                "Removed old screenshot from extra queue:",
-                removedPath
-              )
-            } catch (error) {
-              console.error("Error removing old screenshot:", error)
-            }
+            void this.discardScreenshot(removedPath)
+            console.log(
+              "Removed old screenshot from extra queue:",
+              removedPath
+            )
           }
         }
       }
+
+      if (duplicate) {
+        console.log(`Replaced duplicate capture ${duplicate.path} (distance ${duplicate.distance})`)
+        this.emit("duplicate", {
+          action: "replace",
+          path: screenshotPath,
+          replacedPath: duplicate.path,
+          distance: duplicate.distance
+        } as DuplicateScreenshotEvent)
+      }
     } catch (error) {
       console.error("Screenshot error:", error)
       throw error
     } finally {
-      // Increased delay for showing window again
-      await new Promise((resolve) => setTimeout(resolve, 200))
-      showMainWindow()
+      restoreWindow()
+      screenshotSpan.end()
     }
 
     return screenshotPath
   }
 
-  public async getImagePreview(filepath: string): Promise<string> {
-    try {
-      if (!fs.existsSync(filepath)) {
-        console.error(`Image file not found: ${filepath}`);
-        return '';
+  /**
+   * Closest queued screenshot within maxDistance bits of a capture's hash
+   */
+  private findDuplicate(
+    queue: string[],
+    hash: string,
+    maxDistance: number
+  ): { path: string; distance: number } | null {
+    let closest: { path: string; distance: number } | null = null
+    for (const queuedPath of queue) {
+      const queuedHash = this.screenshotHashes.get(queuedPath)
+      if (!queuedHash) continue
+      const distance = hammingDistance(hash, queuedHash)
+      if (distance <= maxDistance && (!closest || distance < closest.distance)) {
+        closest = { path: queuedPath, distance }
       }
-      
-      const data = await fs.promises.readFile(filepath)
-      return `data:image/png;base64,${data.toString("base64")}`
-    } catch (error) {
-      console.error("Error reading image:", error)
-      return ''
     }
+    return closest
+  }
+
+  /**
+   * Queue a stored capture, taking over the slot of the duplicate it replaces
+   */
+  private enqueue(queue: string[], screenshotPath: string, replacedPath: string | null): void {
+    const index = replacedPath ? queue.indexOf(replacedPath) : -1
+    if (replacedPath && index !== -1) {
+      queue[index] = screenshotPath
+      void this.discardScreenshot(replacedPath)
+    } else {
+      queue.push(screenshotPath)
+    }
+  }
+
+  /**
+   * Downscale a decoded capture to the preview tile height
+   */
+  private createThumbnail(image: NativeImage): NativeImage {
+    const { height } = image.getSize()
+    return height > this.THUMBNAIL_HEIGHT
+      ? image.resize({ height: this.THUMBNAIL_HEIGHT, quality: "good" })
+      : image
+  }
+
+  /**
+   * Thumbnail bytes, created at capture time or on demand
+   */
+  public async getThumbnail(filepath: string): Promise<Buffer> {
+    const cached = this.screenshotThumbnails.get(filepath)
+    if (cached) return cached
+
+    const image = decodeImage(await this.getScreenshotBuffer(filepath))
+    const thumbnail = this.createThumbnail(image).toJPEG(80)
+    if (this.resolveAssetPath(path.parse(filepath).name) === filepath) {
+      this.screenshotThumbnails.set(filepath, thumbnail)
+    }
+    return thumbnail
+  }
+
+  /**
+   * Map an asset id back to a queued screenshot. Only queued files can be
+   * served, so ids can never reach outside the screenshot directories.
+   */
+  public resolveAssetPath(id: string): string | null {
+    return (
+      [...this.screenshotQueue, ...this.extraScreenshotQueue].find(
+        (filepath) => path.parse(filepath).name === id
+      ) || null
+    )
+  }
+
+  /**
+   * Whether a screenshot's bytes are currently held in memory
+   */
+  public isBuffered(filepath: string): boolean {
+    return this.screenshotBuffers.has(filepath)
+  }
+
+  /**
+   * URL the renderer can use as an <img> source for a screenshot asset
+   */
+  public getAssetUrl(kind: ScreenshotAssetKind, filepath: string): string {
+    return `${ASSET_PROTOCOL}://${kind}/${encodeURIComponent(path.parse(filepath).name)}`
+  }
+
+  /**
+   * Preview URL for the renderer. The image itself is served over the asset
+   * protocol, so no image data crosses IPC.
+   */
+  public async getImagePreview(filepath: string): Promise<string> {
+    return this.getAssetUrl("thumbnail", filepath)
+  }
+
+  /**
+   * Perceptual hash of a screenshot, computed at capture time or on demand
+   */
+  public async getScreenshotHash(filepath: string): Promise<string> {
+    const cached = this.screenshotHashes.get(filepath)
+    if (cached) return cached
+
+    // Hashed from the thumbnail-sized copy, like captures are
+    const image = decodeImage(await this.getScreenshotBuffer(filepath))
+    const hash = await imageWorkerPool.run({
+      kind: "hash",
+      bitmap: toPixels(this.createThumbnail(image)),
+      size: this.HASH_SIZE
+    })
+    this.screenshotHashes.set(filepath, hash)
+    return hash
   }
 
   public async deleteScreenshot(
     path: string
   ): Promise<{ success: boolean; error?: string }> {
     try {
-      if (fs.existsSync(path)) {
-        await fs.promises.unlink(path)
-      }
+      await this.discardScreenshot(path)
       
       if (this.view === "queue") {
         this.screenshotQueue = this.screenshotQueue.filter(
@@ -373,15 +895,7 @@ export class ScreenshotHelper {
   public clearExtraScreenshotQueue(): void {
     // Clear extraScreenshotQueue
     this.extraScreenshotQueue.forEach((screenshotPath) => {
-      if (fs.existsSync(screenshotPath)) {
-        fs.unlink(screenshotPath, (err) => {
-          if (err)
-            console.error(
-              `Error deleting extra screenshot at ${screenshotPath}:`,
-              err
-            )
-        })
-      }
+      void this.discardScreenshot(screenshotPath)
     })
     this.extraScreenshotQueue = []
   }
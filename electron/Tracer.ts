@@ -0,0 +1,297 @@
+// Tracer.ts
+import fs from "node:fs"
+import path from "node:path"
+import { app } from "electron"
+import { v4 as uuidv4 } from "uuid"
+import { configHelper } from "./ConfigHelper"
+
+export type TraceProcess = "main" | "renderer"
+
+// A finished span, as recorded here or reported by the renderer
+export interface TraceSpanRecord {
+  traceId: string
+  name: string
+  lane: string            // Timeline row, e.g. "capture" or "request:openai"
+  start: number           // Epoch milliseconds
+  duration: number        // Milliseconds
+  process?: TraceProcess
+  args?: Record<string, unknown>
+}
+
+export interface TraceSpan {
+  end: (args?: Record<string, unknown>) => void
+}
+
+const NOOP_SPAN: TraceSpan = { end: () => {} }
+
+const PROCESS_IDS: Record<TraceProcess, number> = { main: 1, renderer: 2 }
+
+/**
+ * Epoch milliseconds with sub-millisecond precision. Main and renderer both
+ * derive it from performance.timeOrigin, so their spans share a timeline.
+ */
+export function traceNow(): number {
+  return performance.timeOrigin + performance.now()
+}
+
+/**
+ * Records pipeline spans as Chrome trace events (loadable in Perfetto or
+ * chrome://tracing). Every span carries the ID of the trace it belongs to, so
+ * one screenshot-to-render run can be followed across helpers and processes.
+ * Spans are only recorded while a trace started with tracing enabled is active.
+ */
+export class Tracer {
+  private readonly MAX_FILE_BYTES = 10 * 1024 * 1024
+  private readonly MAX_FILES = 3
+  private readonly FLUSH_DELAY_MS = 1000
+
+  private traceDir: string | null = null
+  private currentTraceId: string | null = null
+  private pendingEvents: string[] = []
+  private flushTimer: NodeJS.Timeout | null = null
+  private writeChain: Promise<void> = Promise.resolve()
+  private fileBytes: number | null = null   // Size of trace.json, null until this session's first write
+  private lanes = new Map<string, { process: TraceProcess; lane: string; tid: number }>()
+
+  constructor() {
+    // Spans wait up to FLUSH_DELAY_MS before being written; don't lose the
+    // last ones when the app quits within that window
+    try {
+      app.on('will-quit', () => this.flushSync())
+    } catch (err) {
+      console.warn('Could not register trace flush on quit:', err)
+    }
+  }
+
+  private getTraceDir(): string {
+    if (!this.traceDir) {
+      try {
+        this.traceDir = path.join(app.getPath('userData'), 'traces');
+      } catch (err) {
+        console.warn('Could not access user data path for traces, using fallback');
+        this.traceDir = path.join(process.cwd(), 'traces');
+      }
+    }
+    return this.traceDir
+  }
+
+  /**
+   * Start a new trace and make it current. Returns null, and records nothing
+   * until the next trace, when tracing is disabled.
+   */
+  public beginTrace(label: string): string | null {
+    if (!configHelper.getConfig().tracingEnabled) {
+      this.currentTraceId = null
+      return null
+    }
+    this.currentTraceId = uuidv4()
+    this.instant(`begin ${label}`, "trace")
+    return this.currentTraceId
+  }
+
+  /**
+   * The current trace, starting one if none is active
+   */
+  public ensureTrace(label: string): string | null {
+    return this.currentTraceId ?? this.beginTrace(label)
+  }
+
+  public getTraceId(): string | null {
+    return this.currentTraceId
+  }
+
+  public startSpan(
+    name: string,
+    lane: string,
+    args?: Record<string, unknown>,
+    traceId: string | null = this.currentTraceId
+  ): TraceSpan {
+    if (!traceId) return NOOP_SPAN
+
+    const start = traceNow()
+    return {
+      end: (endArgs) =>
+        this.record({
+          traceId,
+          name,
+          lane,
+          start,
+          duration: traceNow() - start,
+          args: endArgs ? { ...args, ...endArgs } : args
+        })
+    }
+  }
+
+  /**
+   * Run an async function inside a span
+   */
+  public async trace<T>(
+    name: string,
+    lane: string,
+    fn: () => Promise<T>,
+    args?: Record<string, unknown>
+  ): Promise<T> {
+    const span = this.startSpan(name, lane, args)
+    try {
+      return await fn()
+    } finally {
+      span.end()
+    }
+  }
+
+  /**
+   * Mark a point in time, such as an IPC send or the first streamed token
+   */
+  public instant(
+    name: string,
+    lane: string,
+    args?: Record<string, unknown>,
+    traceId: string | null = this.currentTraceId
+  ): void {
+    if (!traceId) return
+    this.record({ traceId, name, lane, start: traceNow(), duration: 0, args })
+  }
+
+  public record(span: TraceSpanRecord): void {
+    const pid = PROCESS_IDS[span.process || "main"]
+    const tid = this.getLaneId(span.process || "main", span.lane)
+    this.pendingEvents.push(JSON.stringify({
+      name: span.name,
+      cat: span.lane.split(":")[0],
+      ph: span.duration > 0 ? "X" : "i",
+      ...(span.duration > 0 ? {} : { s: "t" }),
+      ts: Math.round(span.start * 1000),
+      dur: span.duration > 0 ? Math.round(span.duration * 1000) : undefined,
+      pid,
+      tid,
+      args: { traceId: span.traceId, ...span.args }
+    }))
+    this.scheduleFlush()
+  }
+
+  /**
+   * Map a lane to a stable thread ID, naming it the first time it is used
+   */
+  private getLaneId(process: TraceProcess, lane: string): number {
+    const key = `${process}/${lane}`
+    let entry = this.lanes.get(key)
+    if (!entry) {
+      entry = { process, lane, tid: this.lanes.size + 1 }
+      this.lanes.set(key, entry)
+      this.pendingEvents.push(this.getLaneMetadata(entry))
+    }
+    return entry.tid
+  }
+
+  private getLaneMetadata(entry: { process: TraceProcess; lane: string; tid: number }): string {
+    return JSON.stringify({
+      name: "thread_name",
+      ph: "M",
+      pid: PROCESS_IDS[entry.process],
+      tid: entry.tid,
+      args: { name: entry.lane }
+    })
+  }
+
+  private scheduleFlush(): void {
+    if (this.flushTimer) return
+    this.flushTimer = setTimeout(() => {
+      this.flushTimer = null
+      void this.flush()
+    }, this.FLUSH_DELAY_MS)
+  }
+
+  /**
+   * Write a fresh file header: the array opener plus process and lane names,
+   * which Perfetto needs in every file
+   */
+  private getFileHeader(): string {
+    const metadata = [
+      ...Object.entries(PROCESS_IDS).map(([name, pid]) =>
+        JSON.stringify({ name: "process_name", ph: "M", pid, args: { name } })
+      ),
+      ...Array.from(this.lanes.values()).map((entry) => this.getLaneMetadata(entry))
+    ]
+    return `[\n${metadata.join(",\n")}`
+  }
+
+  /**
+   * Close trace.json and shift it to trace.1.json, dropping the oldest file.
+   * Synchronous so the quit-time flush can use it; it runs about once per
+   * session and only renames files.
+   */
+  private rotate(dir: string): void {
+    const current = path.join(dir, 'trace.json')
+    if (!fs.existsSync(current)) return
+    fs.appendFileSync(current, "\n]\n")
+    for (let index = this.MAX_FILES - 1; index >= 1; index--) {
+      const from = index === 1 ? current : path.join(dir, `trace.${index - 1}.json`)
+      try {
+        fs.renameSync(from, path.join(dir, `trace.${index}.json`))
+      } catch (err: any) {
+        if (err?.code !== 'ENOENT') throw err
+      }
+    }
+  }
+
+  /**
+   * Chunk to append for a batch of events, rotating first when this session
+   * has no file yet or the current one grew too large
+   */
+  private prepareChunk(dir: string, events: string[]): string {
+    let chunk = `,\n${events.join(",\n")}`
+    if (this.fileBytes === null || this.fileBytes > this.MAX_FILE_BYTES) {
+      this.rotate(dir)
+      chunk = this.getFileHeader() + chunk
+      this.fileBytes = 0
+    }
+    this.fileBytes += Buffer.byteLength(chunk)
+    return chunk
+  }
+
+  /**
+   * Append pending events to trace.json. The closing bracket is left off
+   * while the file is live, which the trace format allows.
+   */
+  public flush(): Promise<void> {
+    if (this.pendingEvents.length === 0) return this.writeChain
+
+    const events = this.pendingEvents
+    this.pendingEvents = []
+    this.writeChain = this.writeChain.then(async () => {
+      try {
+        const dir = this.getTraceDir()
+        await fs.promises.mkdir(dir, { recursive: true })
+        await fs.promises.appendFile(path.join(dir, 'trace.json'), this.prepareChunk(dir, events))
+      } catch (err) {
+        console.error("Error writing trace events:", err)
+      }
+    })
+    return this.writeChain
+  }
+
+  /**
+   * Write pending events immediately. Only for shutdown, when the event loop
+   * may not get to the delayed flush.
+   */
+  public flushSync(): void {
+    if (this.flushTimer) {
+      clearTimeout(this.flushTimer)
+      this.flushTimer = null
+    }
+    if (this.pendingEvents.length === 0) return
+
+    const events = this.pendingEvents
+    this.pendingEvents = []
+    try {
+      const dir = this.getTraceDir()
+      fs.mkdirSync(dir, { recursive: true })
+      fs.appendFileSync(path.join(dir, 'trace.json'), this.prepareChunk(dir, events))
+    } catch (err) {
+      console.error("Error writing trace events:", err)
+    }
+  }
+}
+
+// Export a singleton instance
+export const tracer = new Tracer()
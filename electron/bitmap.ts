@@ -0,0 +1,104 @@
+// bitmap.ts
+// Raw-pixel operations for the image worker. Decoding, resizing and encoding
+// stay on nativeImage in the main thread; workers only see raw pixels.
+
+// Decoded image with 8-bit four-channel pixels. Copies taken from nativeImage
+// are BGRA or RGBA depending on the platform, so analysis code treats the
+// colour channels alike.
+export interface Bitmap {
+  width: number
+  height: number
+  data: Uint8Array
+}
+
+/**
+ * Source pixels and weights contributing to each output pixel along one axis.
+ * Every output pixel averages the source area it covers, which keeps thin
+ * text strokes visible when downscaling.
+ */
+function axisWeights(sourceSize: number, targetSize: number): Array<{ start: number; weights: number[] }> {
+  const scale = sourceSize / targetSize
+  const spans: Array<{ start: number; weights: number[] }> = []
+  for (let target = 0; target < targetSize; target++) {
+    const from = target * scale
+    const to = Math.min(sourceSize, from + scale)
+    const start = Math.min(sourceSize - 1, Math.floor(from))
+    const weights: number[] = []
+    for (let source = start; source < to; source++) {
+      weights.push((Math.min(to, source + 1) - Math.max(from, source)) / (to - from))
+    }
+    spans.push({ start, weights })
+  }
+  return spans
+}
+
+/**
+ * Area-average resample, done as a horizontal then a vertical pass
+ */
+export function resizeBitmap(bitmap: Bitmap, width: number, height: number): Bitmap {
+  width = Math.max(1, Math.round(width))
+  height = Math.max(1, Math.round(height))
+  if (width === bitmap.width && height === bitmap.height) return bitmap
+
+  const columns = axisWeights(bitmap.width, width)
+  const rows = axisWeights(bitmap.height, height)
+
+  const horizontal = new Float32Array(width * bitmap.height * 4)
+  for (let y = 0; y < bitmap.height; y++) {
+    const sourceRow = y * bitmap.width * 4
+    for (let x = 0; x < width; x++) {
+      const { start, weights } = columns[x]
+      let r = 0, g = 0, b = 0, a = 0
+      for (let i = 0; i < weights.length; i++) {
+        const offset = sourceRow + (start + i) * 4
+        const weight = weights[i]
+        r += bitmap.data[offset] * weight
+        g += bitmap.data[offset + 1] * weight
+        b += bitmap.data[offset + 2] * weight
+        a += bitmap.data[offset + 3] * weight
+      }
+      const offset = (y * width + x) * 4
+      horizontal[offset] = r
+      horizontal[offset + 1] = g
+      horizontal[offset + 2] = b
+      horizontal[offset + 3] = a
+    }
+  }
+
+  const data = new Uint8Array(width * height * 4)
+  for (let y = 0; y < height; y++) {
+    const { start, weights } = rows[y]
+    for (let x = 0; x < width; x++) {
+      let r = 0, g = 0, b = 0, a = 0
+      for (let i = 0; i < weights.length; i++) {
+        const offset = ((start + i) * width + x) * 4
+        const weight = weights[i]
+        r += horizontal[offset] * weight
+        g += horizontal[offset + 1] * weight
+        b += horizontal[offset + 2] * weight
+        a += horizontal[offset + 3] * weight
+      }
+      const offset = (y * width + x) * 4
+      data[offset] = Math.round(r)
+      data[offset + 1] = Math.round(g)
+      data[offset + 2] = Math.round(b)
+      data[offset + 3] = Math.round(a)
+    }
+  }
+  return { width, height, data }
+}
+
+/**
+ * Replace every pixel with its luma, in place. The weights assume BGRA, the
+ * order nativeImage bitmaps use.
+ */
+export function grayscaleBitmap(bitmap: Bitmap): Bitmap {
+  const { data } = bitmap
+  for (let offset = 0; offset < data.length; offset += 4) {
+    const luma = Math.round(data[offset] * 0.114 + data[offset + 1] * 0.587 + data[offset + 2] * 0.299)
+    data[offset] = luma
+    data[offset + 1] = luma
+    data[offset + 2] = luma
+  }
+  return bitmap
+}
@@ -0,0 +1,57 @@
+// imageHash.ts
+import { Bitmap, resizeBitmap } from "./bitmap"
+
+/**
+ * Compute a difference hash (dHash) of a decoded image.
+ * The image is shrunk to (size + 1) x size, converted to grayscale and each bit
+ * records whether a pixel is brighter than its right-hand neighbour. Recaptures
+ * of the same screen produce identical or nearly identical hashes. The default
+ * 64-bit hash tolerates small changes; larger sizes tell apart screens that
+ * share a layout, such as the same page scrolled.
+ */
+export function differenceHash(image: Bitmap, size = 8): string {
+  const hashWidth = size + 1
+  const hashHeight = size
+  if (image.width === 0 || image.height === 0) {
+    throw new Error("Cannot hash an empty image")
+  }
+
+  const bitmap = resizeBitmap(image, hashWidth, hashHeight).data
+
+  const luminance = (x: number, y: number): number => {
+    const offset = (y * hashWidth + x) * 4
+    return bitmap[offset] + bitmap[offset + 1] + bitmap[offset + 2]
+  }
+
+  let hex = ""
+  let nibble = 0
+  let bitCount = 0
+  for (let y = 0; y < hashHeight; y++) {
+    for (let x = 0; x < hashWidth - 1; x++) {
+      nibble = (nibble << 1) | (luminance(x, y) > luminance(x + 1, y) ? 1 : 0)
+      bitCount++
+      if (bitCount % 4 === 0) {
+        hex += nibble.toString(16)
+        nibble = 0
+      }
+    }
+  }
+  return hex
+}
+
+/**
+ * Number of differing bits between two hex-encoded hashes of equal length
+ */
+export function hammingDistance(a: string, b: string): number {
+  if (a.length !== b.length) return Number.MAX_SAFE_INTEGER
+
+  let distance = 0
+  for (let i = 0; i < a.length; i++) {
+    let diff = parseInt(a[i], 16) ^ parseInt(b[i], 16)
+    while (diff) {
+      distance += diff & 1
+      diff >>= 1
+    }
+  }
+  return distance
+}
@@ -0,0 +1,49 @@
+// imageWorker.ts
+// Entry point of the image pool's worker threads. The task functions are also
+// exported so the pool can run them inline if a worker cannot be started.
+// nativeImage is not available here, so tasks take raw pixels the main thread
+// has already decoded and, for analysis, downscaled.
+import { parentPort } from "node:worker_threads"
+import { Bitmap, grayscaleBitmap } from "./bitmap"
+import { ContentCrop, detectContentRegion } from "./ContentCropper"
+import { differenceHash } from "./imageHash"
+
+// Pixel buffers are transferred to the worker, not copied
+export type ImageTask =
+  | { kind: "hash"; bitmap: Bitmap; size: number }
+  | { kind: "detectContent"; bitmap: Bitmap; sourceWidth: number; sourceHeight: number }
+  | { kind: "grayscale"; bitmap: Bitmap }
+
+export interface ImageTaskResults {
+  hash: string
+  detectContent: ContentCrop | null   // Null when there is nothing to crop
+  grayscale: Bitmap
+}
+
+export type ImageTaskKind = ImageTask["kind"]
+
+export function runImageTask<K extends ImageTaskKind>(task: Extract<ImageTask, { kind: K }>): ImageTaskResults[K]
+export function runImageTask(task: ImageTask): ImageTaskResults[ImageTaskKind] {
+  switch (task.kind) {
+    case "hash":
+      return differenceHash(task.bitmap, task.size)
+    case "detectContent":
+      return detectContentRegion(task.bitmap, { width: task.sourceWidth, height: task.sourceHeight })
+    case "grayscale":
+      return grayscaleBitmap(task.bitmap)
+  }
+}
+
+if (parentPort) {
+  const port = parentPort
+  port.on("message", ({ id, task }: { id: number; task: ImageTask }) => {
+    try {
+      const result = runImageTask(task)
+      // Pixel results go back without a copy
+      const transfer = result && typeof result === "object" && "data" in result ? [result.data.buffer] : []
+      port.postMessage({ id, result }, transfer as ArrayBuffer[])
+    } catch (error) {
+      port.postMessage({ id, error: error instanceof Error ? error.message : String(error) })
+    }
+  })
+}
@@ -4,13 +4,16 @@ import { ipcMain, shell, dialog } from "electron"
 import { randomBytes } from "crypto"
 import { IIpcHandlerDeps } from "./main"
 import { configHelper } from "./ConfigHelper"
+import { extractionCache } from "./ExtractionCache"
+import { historyStore } from "./HistoryStore"
+import { tracer, TraceSpanRecord } from "./Tracer"
 
 export function initializeIpcHandlers(deps: IIpcHandlerDeps): void {
   console.log("Initializing IPC handlers")
 
   // Configuration handlers
   ipcMain.handle("get-config", () => {
-    return configHelper.loadConfig();
+    return configHelper.getConfig();
   })
 
   ipcMain.handle("update-config", (_event, updates) => {
@@ -35,40 +38,89 @@ export function initializeIpcHandlers(deps: IIpcHandlerDeps): void {
     return result;
   })
 
-  // Credits handlers
-  ipcMain.handle("set-initial-credits", async (_event, credits: number) => {
-    const mainWindow = deps.getMainWindow()
-    if (!mainWindow) return
+  // Extraction cache handlers
+  ipcMain.handle("get-extraction-cache-stats", () => {
+    return extractionCache.getStats();
+  })
 
+  ipcMain.handle("clear-extraction-cache", async () => {
     try {
-      // Set the credits in a way that ensures atomicity
-      await mainWindow.webContents.executeJavaScript(
-        `window.__CREDITS__ = ${credits}`
-      )
-      mainWindow.webContents.send("credits-updated", credits)
+      await extractionCache.clear();
+      return { success: true };
     } catch (error) {
-      console.error("Error setting initial credits:", error)
-      throw error
+      console.error("Error clearing extraction cache:", error);
+      return { success: false, error: "Failed to clear extraction cache" };
     }
   })
 
-  ipcMain.handle("decrement-credits", async () => {
-    const mainWindow = deps.getMainWindow()
-    if (!mainWindow) return
+  // Solve history handlers
+  ipcMain.handle("get-history-stats", () => {
+    return historyStore.getStats();
+  })
 
+  ipcMain.handle("clear-history", async () => {
     try {
-      const currentCredits = await mainWindow.webContents.executeJavaScript(
-        "window.__CREDITS__"
-      )
-      if (currentCredits > 0) {
-        const newCredits = currentCredits - 1
-        await mainWindow.webContents.executeJavaScript(
-          `window.__CREDITS__ = ${newCredits}`
-        )
-        mainWindow.webContents.send("credits-updated", newCredits)
-      }
+      await historyStore.clear();
+      return { success: true };
     } catch (error) {
-      console.error("Error decrementing credits:", error)
+      console.error("Error clearing solve history:", error);
+      return { success: false, error: "Failed to clear solve history" };
+    }
+  })
+
+  // Auto-crop handlers
+  ipcMain.handle("get-screenshot-crop", (_event, path: string) => {
+    if (!configHelper.getConfig().cropOverlay) return null
+    return deps.getContentCrop(path)
+  })
+
+  ipcMain.handle("get-crop-stats", () => {
+    return deps.getCropStats()
+  })
+
+  // Tracing handlers
+  ipcMain.handle("report-trace-spans", (_event, spans: TraceSpanRecord[]) => {
+    if (!Array.isArray(spans)) return
+    // Only spans for the live trace are kept; stale reports from a previous run are dropped
+    spans
+      .filter((span) => span && span.traceId && span.traceId === tracer.getTraceId())
+      .forEach((span) => tracer.record({ ...span, process: "renderer" }))
+  })
+
+  // Sent once by the renderer after it has mounted and loaded its settings
+  ipcMain.on("renderer-ready", (_event, rendererState: { language?: string; credits?: number }) => {
+    deps.processingHelper?.setRendererState(rendererState ?? {})
+    console.log("Renderer ready")
+  })
+
+  // Push language changes made outside the renderer, e.g. by editing config.json
+  let lastLanguage = configHelper.getLanguage()
+  configHelper.on("config-updated", (config) => {
+    const language = config.language || "python"
+    if (language === lastLanguage) return
+    lastLanguage = language
+    deps.processingHelper?.setRendererState({ language })
+    const mainWindow = deps.getMainWindow()
+    if (mainWindow && !mainWindow.isDestroyed()) {
+      mainWindow.webContents.send("language-changed", language)
+    }
+  })
+
+  // Credits handlers; the main process holds the count and pushes changes
+  ipcMain.handle("set-initial-credits", (_event, credits: number) => {
+    deps.processingHelper?.setRendererState({ credits })
+    deps.getMainWindow()?.webContents.send("credits-updated", credits)
+  })
+
+  ipcMain.handle("decrement-credits", () => {
+    const processingHelper = deps.processingHelper
+    if (!processingHelper) return
+
+    const currentCredits = processingHelper.getCredits()
+    if (currentCredits > 0) {
+      const newCredits = currentCredits - 1
+      processingHelper.setRendererState({ credits: newCredits })
+      deps.getMainWindow()?.webContents.send("credits-updated", newCredits)
     }
   })
 
@@ -122,6 +174,7 @@ export function initializeIpcHandlers(deps: IIpcHandlerDeps): void {
 
   // Screenshot management handlers
   ipcMain.handle("get-screenshots", async () => {
+    const span = tracer.startSpan("get-screenshots", "ipc")
     try {
       let previews = []
       const currentView = deps.getView()
@@ -148,6 +201,8 @@ export function initializeIpcHandlers(deps: IIpcHandlerDeps): void {
     } catch (error) {
       console.error("Error getting screenshots:", error)
       throw error
+    } finally {
+      span.end()
     }
   })
 
@@ -156,12 +211,16 @@ export function initializeIpcHandlers(deps: IIpcHandlerDeps): void {
     const mainWindow = deps.getMainWindow()
     if (mainWindow) {
       try {
+        const captureStartedAt = Date.now()
         const screenshotPath = await deps.takeScreenshot()
+        const span = tracer.startSpan("send screenshot-taken", "ipc")
         const preview = await deps.getImagePreview(screenshotPath)
         mainWindow.webContents.send("screenshot-taken", {
           path: screenshotPath,
           preview
         })
+        span.end()
+        console.log(`Capture to preview: ${Date.now() - captureStartedAt} ms`)
         return { success: true }
       } catch (error) {
         console.error("Error triggering screenshot:", error)
@@ -1,16 +1,52 @@
-import { app, BrowserWindow, screen, shell, ipcMain } from "electron"
+import { app, BrowserWindow, screen, shell, ipcMain, protocol, net } from "electron"
 import path from "path"
 import fs from "fs"
+import { pathToFileURL } from "url"
 import { initializeIpcHandlers } from "./ipcHandlers"
 import { ProcessingHelper } from "./ProcessingHelper"
-import { ScreenshotHelper } from "./ScreenshotHelper"
+import {
+  ASSET_PROTOCOL,
+  DuplicateScreenshotEvent,
+  ScreenshotAssetKind,
+  ScreenshotHelper
+} from "./ScreenshotHelper"
+import { RelativeCrop } from "./ContentCropper"
 import { ShortcutsHelper } from "./shortcuts"
+import { selectRegion } from "./regionSelector"
 import { initAutoUpdater } from "./autoUpdater"
 import { configHelper } from "./ConfigHelper"
 import * as dotenv from "dotenv"
 
 // Constants
 const isDev = process.env.NODE_ENV === "development"
+// Set by `npm run bench:startup`: report startup timings on stdout and quit
+const isStartupBenchmark = process.env.INTERVIEW_CODER_STARTUP_BENCH === "1"
+
+// Startup milestones as epoch milliseconds. performance.timeOrigin is when
+// this process started, so it anchors the first one.
+const startupMarks: Record<string, number> = {
+  processStart: performance.timeOrigin
+}
+
+let startupReported = false
+
+function markStartup(name: string): void {
+  startupMarks[name] = performance.timeOrigin + performance.now()
+  const done = ["firstPaint", "shortcutsRegistered", "housekeepingDone"].every((mark) => startupMarks[mark])
+  if (done && !startupReported) {
+    startupReported = true
+    const since = (mark: string) => Math.round(startupMarks[mark] - startupMarks.processStart)
+    console.log(
+      `Startup: app ready ${since("appReady")} ms, window created ${since("windowCreated")} ms, ` +
+      `first paint ${since("firstPaint")} ms, shortcuts registered ${since("shortcutsRegistered")} ms, ` +
+      `housekeeping done ${since("housekeepingDone")} ms`
+    )
+    if (isStartupBenchmark) {
+      process.stdout.write(`STARTUP_TIMINGS ${JSON.stringify(startupMarks)}\n`)
+      app.quit()
+    }
+  }
+}
 
 // Application State
 const state = {
@@ -44,6 +80,7 @@ const state = {
     INITIAL_START: "initial-start",
     PROBLEM_EXTRACTED: "problem-extracted",
     SOLUTION_SUCCESS: "solution-success",
+    SOLUTION_CHUNK: "solution-chunk",
     INITIAL_SOLUTION_ERROR: "solution-error",
     DEBUG_START: "debug-start",
     DEBUG_SUCCESS: "debug-success",
@@ -75,6 +112,7 @@ export interface IProcessingHelperDeps {
 export interface IShortcutsHelperDeps {
   getMainWindow: () => BrowserWindow | null
   takeScreenshot: () => Promise<string>
+  selectCaptureRegion: () => Promise<boolean>
   getImagePreview: (filepath: string) => Promise<string>
   processingHelper: ProcessingHelper | null
   clearQueues: () => void
@@ -96,6 +134,8 @@ export interface IIpcHandlerDeps {
     path: string
   ) => Promise<{ success: boolean; error?: string }>
   getImagePreview: (filepath: string) => Promise<string>
+  getContentCrop: (filepath: string) => RelativeCrop | null
+  getCropStats: () => ReturnType<ScreenshotHelper["getCropStats"]> | null
   processingHelper: ProcessingHelper | null
   PROCESSING_EVENTS: typeof state.PROCESSING_EVENTS
   takeScreenshot: () => Promise<string>
@@ -112,6 +152,9 @@ export interface IIpcHandlerDeps {
 // Initialize helpers
 function initializeHelpers() {
   state.screenshotHelper = new ScreenshotHelper(state.view)
+  state.screenshotHelper.on("duplicate", (event: DuplicateScreenshotEvent) => {
+    state.mainWindow?.webContents.send("screenshot-duplicate", event)
+  })
   state.processingHelper = new ProcessingHelper({
     getScreenshotHelper,
     getMainWindow,
@@ -132,6 +175,7 @@ function initializeHelpers() {
   state.shortcutsHelper = new ShortcutsHelper({
     getMainWindow,
     takeScreenshot,
+    selectCaptureRegion,
     getImagePreview,
     processingHelper: state.processingHelper,
     clearQueues,
@@ -172,6 +216,15 @@ if (process.defaultApp && process.argv.length >= 2) {
   ])
 }
 
+// Screenshot assets are served over a privileged scheme so the renderer can
+// load them as plain <img> URLs. Must be registered before the app is ready.
+protocol.registerSchemesAsPrivileged([
+  {
+    scheme: ASSET_PROTOCOL,
+    privileges: { standard: true, secure: true, supportFetchAPI: true, stream: true }
+  }
+])
+
 // Force Single Instance Lock
 const gotTheLock = app.requestSingleInstanceLock()
 
@@ -243,6 +296,15 @@ async function createWindow(): Promise<void> {
   // Add more detailed logging for window events
   state.mainWindow.webContents.on("did-finish-load", () => {
     console.log("Window finished loading")
+    if (startupMarks.firstPaint) return
+    // Resolves after the frame following the load has been painted
+    state.mainWindow?.webContents
+      .executeJavaScript(
+        "new Promise((resolve) => requestAnimationFrame(() => requestAnimationFrame(() => resolve(true))))",
+        true
+      )
+      .then(() => markStartup("firstPaint"))
+      .catch((error) => console.warn("Could not time first paint:", error))
   })
   state.mainWindow.webContents.on(
     "did-fail-load",
@@ -422,6 +484,28 @@ function showMainWindow(): void {
   }
 }
 
+/**
+ * Hide the window for a capture and resolve once it is off screen. The window
+ * hides by going transparent rather than with hide(), so there is no hide
+ * event; instead wait for the renderer to present two more frames, by which
+ * point the compositor has applied the new opacity.
+ */
+function hideMainWindowForCapture(): Promise<void> {
+  const mainWindow = state.mainWindow
+  if (!mainWindow || mainWindow.isDestroyed()) return Promise.resolve()
+
+  const wasVisible = state.isWindowVisible
+  hideMainWindow()
+  if (!wasVisible) return Promise.resolve()
+
+  return mainWindow.webContents
+    .executeJavaScript(
+      "new Promise((resolve) => requestAnimationFrame(() => requestAnimationFrame(() => resolve(true))))",
+      true
+    )
+    .then(() => undefined)
+}
+
 function toggleMainWindow(): void {
   console.log(`Toggling window. Current state: ${state.isWindowVisible ? 'visible' : 'hidden'}`);
   if (state.isWindowVisible) {
@@ -504,19 +588,22 @@ function loadEnvVariables() {
 
 // Initialize application
 async function initializeApp() {
+  markStartup("appReady")
   try {
     // Set custom cache directory to prevent permission issues
-    const appDataPath = path.join(app.getPath('appData'), 'interview-coder-v1')
+    // The startup benchmark runs against a throwaway profile
+    const appDataPath = (isStartupBenchmark && process.env.INTERVIEW_CODER_APP_DATA) ||
+      path.join(app.getPath('appData'), 'interview-coder-v1')
     const sessionPath = path.join(appDataPath, 'session')
     const tempPath = path.join(appDataPath, 'temp')
     const cachePath = path.join(appDataPath, 'cache')
     
-    // Create directories if they don't exist
-    for (const dir of [appDataPath, sessionPath, tempPath, cachePath]) {
-      if (!fs.existsSync(dir)) {
-        fs.mkdirSync(dir, { recursive: true })
-      }
-    }
+    // Create directories if they don't exist; setPath requires them
+    await Promise.all(
+      [appDataPath, sessionPath, tempPath, cachePath].map((dir) =>
+        fs.promises.mkdir(dir, { recursive: true })
+      )
+    )
     
     app.setPath('userData', appDataPath)
     app.setPath('sessionData', sessionPath)      
@@ -531,6 +618,7 @@ async function initializeApp() {
     }
     
     initializeHelpers()
+    registerAssetProtocol()
     initializeIpcHandlers({
       getMainWindow,
       setWindowDimensions,
@@ -538,6 +626,8 @@ async function initializeApp() {
       getExtraScreenshotQueue,
       deleteScreenshot,
       getImagePreview,
+      getContentCrop: (filepath) => state.screenshotHelper?.getContentCrop(filepath) ?? null,
+      getCropStats: () => state.screenshotHelper?.getCropStats() ?? null,
       processingHelper: state.processingHelper,
       PROCESSING_EVENTS: state.PROCESSING_EVENTS,
       takeScreenshot,
@@ -560,9 +650,19 @@ async function initializeApp() {
       moveWindowDown: () => moveWindowVertical((y) => y + state.step)
     })
     await createWindow()
+    markStartup("windowCreated")
     state.shortcutsHelper?.registerGlobalShortcuts()
+    markStartup("shortcutsRegistered")
+
+    // Housekeeping waits until the window is up and never blocks it
+    setImmediate(() => {
+      Promise.resolve(state.screenshotHelper?.startHousekeeping())
+        .catch((error) => console.error("Startup housekeeping failed:", error))
+        .finally(() => markStartup("housekeepingDone"))
+    })
 
     // Initialize auto-updater regardless of environment
+    if (isStartupBenchmark) return
     initAutoUpdater()
     console.log(
       "Auto-updater initialized in",
@@ -647,6 +747,7 @@ function getExtraScreenshotQueue(): string[] {
 }
 
 function clearQueues(): void {
+  state.processingHelper?.cancelSpeculativeExtraction()
   state.screenshotHelper?.clearQueues()
   state.problemInfo = null
   setView("queue")
@@ -654,12 +755,64 @@ function clearQueues(): void {
 
 async function takeScreenshot(): Promise<string> {
   if (!state.mainWindow) throw new Error("No main window available")
-  return (
-    state.screenshotHelper?.takeScreenshot(
-      () => hideMainWindow(),
+  // A capture means a request is coming; warm the socket while we capture
+  state.processingHelper?.prewarmConnection("screenshot")
+  const screenshotPath =
+    (await state.screenshotHelper?.takeScreenshot(
+      () => hideMainWindowForCapture(),
       () => showMainWindow()
-    ) || ""
-  )
+    )) || ""
+
+  // Queue changed, so restart background extraction if it is enabled
+  state.processingHelper?.prefetchOcr(screenshotPath)
+  state.processingHelper?.startSpeculativeExtraction()
+  return screenshotPath
+}
+
+// Let the user draw a capture rectangle on the display under the cursor and
+// switch to region captures. Returns false if the selection was cancelled.
+async function selectCaptureRegion(): Promise<boolean> {
+  const display = screen.getDisplayNearestPoint(screen.getCursorScreenPoint())
+  const region = await selectRegion(display)
+  if (!region) return false
+
+  configHelper.updateConfig({ captureMode: "region", captureRegion: region })
+  console.log(`Capture region set on display ${region.displayId}:`, region)
+  return true
+}
+
+function registerAssetProtocol(): void {
+  protocol.handle(ASSET_PROTOCOL, async (request) => {
+    const { host, pathname } = new URL(request.url)
+    const kind = host as ScreenshotAssetKind
+    const filepath = state.screenshotHelper?.resolveAssetPath(
+      decodeURIComponent(pathname.slice(1))
+    )
+    if (!filepath || (kind !== "screenshot" && kind !== "thumbnail")) {
+      return new Response("Not found", { status: 404 })
+    }
+
+    // Asset ids are unique per capture, so their content never changes
+    const headers = {
+      "Content-Type": kind === "thumbnail" ? "image/jpeg" : "image/png",
+      "Cache-Control": "private, max-age=31536000, immutable"
+    }
+
+    try {
+      if (kind === "thumbnail") {
+        return new Response(await state.screenshotHelper.getThumbnail(filepath), { headers })
+      }
+      if (state.screenshotHelper.isBuffered(filepath)) {
+        return new Response(await state.screenshotHelper.getScreenshotBuffer(filepath), { headers })
+      }
+      // Released from memory, stream it from disk
+      const fileResponse = await net.fetch(pathToFileURL(filepath).toString())
+      return new Response(fileResponse.body, { status: fileResponse.status, headers })
+    } catch (error) {
+      console.error("Error serving screenshot asset:", error)
+      return new Response("Error reading asset", { status: 500 })
+    }
+  })
 }
 
 async function getImagePreview(filepath: string): Promise<string> {
@@ -669,12 +822,14 @@ async function getImagePreview(filepath: string): Promise<string> {
 async function deleteScreenshot(
   path: string
 ): Promise<{ success: boolean; error?: string }> {
-  return (
-    state.screenshotHelper?.deleteScreenshot(path) || {
-      success: false,
-      error: "Screenshot helper not initialized"
-    }
-  )
+  const result = (await state.screenshotHelper?.deleteScreenshot(path)) || {
+    success: false,
+    error: "Screenshot helper not initialized"
+  }
+  if (result.success) {
+    state.processingHelper?.startSpeculativeExtraction()
+  }
+  return result
 }
 
 function setHasDebugged(value: boolean): void {
@@ -705,6 +860,7 @@ export {
   getExtraScreenshotQueue,
   clearQueues,
   takeScreenshot,
+  selectCaptureRegion,
   getImagePreview,
   deleteScreenshot,
   setHasDebugged,
@@ -13,6 +13,7 @@ export const PROCESSING_EVENTS = {
   INITIAL_START: "initial-start",
   PROBLEM_EXTRACTED: "problem-extracted",
   SOLUTION_SUCCESS: "solution-success",
+  SOLUTION_CHUNK: "solution-chunk",
   INITIAL_SOLUTION_ERROR: "solution-error",
   RESET: "reset",
 
@@ -66,15 +67,15 @@ const electronAPI = {
       ipcRenderer.removeListener("reset-view", subscription)
     }
   },
-  onSolutionStart: (callback: () => void) => {
-    const subscription = () => callback()
+  onSolutionStart: (callback: (data?: { traceId: string | null }) => void) => {
+    const subscription = (_: any, data?: { traceId: string | null }) => callback(data)
     ipcRenderer.on(PROCESSING_EVENTS.INITIAL_START, subscription)
     return () => {
       ipcRenderer.removeListener(PROCESSING_EVENTS.INITIAL_START, subscription)
     }
   },
-  onDebugStart: (callback: () => void) => {
-    const subscription = () => callback()
+  onDebugStart: (callback: (data?: { traceId: string | null }) => void) => {
+    const subscription = (_: any, data?: { traceId: string | null }) => callback(data)
     ipcRenderer.on(PROCESSING_EVENTS.DEBUG_START, subscription)
     return () => {
       ipcRenderer.removeListener(PROCESSING_EVENTS.DEBUG_START, subscription)
@@ -139,6 +140,13 @@ const electronAPI = {
       )
     }
   },
+  onSolutionChunk: (callback: (data: { field: string; delta: string }) => void) => {
+    const subscription = (_: any, data: { field: string; delta: string }) => callback(data)
+    ipcRenderer.on(PROCESSING_EVENTS.SOLUTION_CHUNK, subscription)
+    return () => {
+      ipcRenderer.removeListener(PROCESSING_EVENTS.SOLUTION_CHUNK, subscription)
+    }
+  },
   onUnauthorized: (callback: () => void) => {
     const subscription = () => callback()
     ipcRenderer.on(PROCESSING_EVENTS.UNAUTHORIZED, subscription)
@@ -193,6 +201,16 @@ const electronAPI = {
       ipcRenderer.removeListener("update-downloaded", subscription)
     }
   },
+  notifyRendererReady: (rendererState: { language: string; credits: number }) =>
+    ipcRenderer.send("renderer-ready", rendererState),
+  onLanguageChanged: (callback: (language: string) => void) => {
+    const subscription = (_event: any, language: string) => callback(language)
+    ipcRenderer.on("language-changed", subscription)
+    return () => {
+      ipcRenderer.removeListener("language-changed", subscription)
+    }
+  },
+  setInitialCredits: (credits: number) => ipcRenderer.invoke("set-initial-credits", credits),
   decrementCredits: () => ipcRenderer.invoke("decrement-credits"),
   onCreditsUpdated: (callback: (credits: number) => void) => {
     const subscription = (_event: any, credits: number) => callback(credits)
@@ -215,6 +233,34 @@ const electronAPI = {
     }
   },
   checkApiKey: () => ipcRenderer.invoke("check-api-key"),
+  getExtractionCacheStats: () => ipcRenderer.invoke("get-extraction-cache-stats"),
+  clearExtractionCache: () => ipcRenderer.invoke("clear-extraction-cache"),
+  getHistoryStats: () => ipcRenderer.invoke("get-history-stats"),
+  clearHistory: () => ipcRenderer.invoke("clear-history"),
+  onScreenshotDuplicate: (
+    callback: (data: { action: "replace" | "skip"; path: string; replacedPath?: string; distance: number }) => void
+  ) => {
+    const subscription = (_: any, data: { action: "replace" | "skip"; path: string; replacedPath?: string; distance: number }) =>
+      callback(data)
+    ipcRenderer.on("screenshot-duplicate", subscription)
+    return () => {
+      ipcRenderer.removeListener("screenshot-duplicate", subscription)
+    }
+  },
+  getScreenshotCrop: (path: string) => ipcRenderer.invoke("get-screenshot-crop", path),
+  getCropStats: () => ipcRenderer.invoke("get-crop-stats"),
+  onScreenshotCrop: (
+    callback: (data: { path: string; crop: { x: number; y: number; width: number; height: number; aspect: number } }) => void
+  ) => {
+    const subscription = (_: any, data: { path: string; crop: { x: number; y: number; width: number; height: number; aspect: number } }) =>
+      callback(data)
+    ipcRenderer.on("screenshot-crop", subscription)
+    return () => {
+      ipcRenderer.removeListener("screenshot-crop", subscription)
+    }
+  },
+  reportTraceSpans: (spans: Array<{ traceId: string; name: string; lane: string; start: number; duration: number }>) =>
+    ipcRenderer.invoke("report-trace-spans", spans),
   validateApiKey: (apiKey: string) => 
     ipcRenderer.invoke("validate-api-key", apiKey),
   openExternal: (url: string) => 
@@ -0,0 +1,127 @@
+// regionSelector.ts
+import { BrowserWindow, Display } from "electron"
+import { CaptureRegion } from "./ConfigHelper"
+
+// Regions smaller than this (in DIPs) are treated as a stray click
+const MIN_REGION_SIZE = 8
+
+// The page reports its result through document.title, which keeps the
+// overlay free of a preload script and IPC channel
+const RESULT_PREFIX = "region:"
+
+const SELECTOR_HTML = `<!DOCTYPE html>
+<html>
+<head>
+<meta charset="utf-8">
+<style>
+  html, body { margin: 0; height: 100%; overflow: hidden; cursor: crosshair; user-select: none; background: rgba(0, 0, 0, 0.3); }
+  body.dragging { background: transparent; }
+  #box { position: fixed; display: none; border: 1px solid #4ade80; box-shadow: 0 0 0 9999px rgba(0, 0, 0, 0.3); }
+  #hint { position: fixed; top: 16px; left: 50%; transform: translateX(-50%); padding: 6px 12px; border-radius: 6px; background: rgba(0, 0, 0, 0.75); color: #fff; font: 13px system-ui, sans-serif; }
+</style>
+</head>
+<body>
+<div id="hint">Drag to select the capture region. Esc to cancel.</div>
+<div id="box"></div>
+<script>
+  const box = document.getElementById("box")
+  let start = null
+
+  const rect = (event) => ({
+    x: Math.min(start.x, event.clientX),
+    y: Math.min(start.y, event.clientY),
+    width: Math.abs(event.clientX - start.x),
+    height: Math.abs(event.clientY - start.y)
+  })
+  const finish = (r) => {
+    document.title = "${RESULT_PREFIX}" + (r ? [r.x, r.y, r.width, r.height].join(",") : "cancel")
+  }
+
+  addEventListener("mousedown", (event) => {
+    start = { x: event.clientX, y: event.clientY }
+    document.body.classList.add("dragging")
+    box.style.display = "block"
+  })
+  addEventListener("mousemove", (event) => {
+    if (!start) return
+    const r = rect(event)
+    Object.assign(box.style, { left: r.x + "px", top: r.y + "px", width: r.width + "px", height: r.height + "px" })
+  })
+  addEventListener("mouseup", (event) => {
+    if (!start) return
+    const r = rect(event)
+    start = null
+    finish(r.width >= ${MIN_REGION_SIZE} && r.height >= ${MIN_REGION_SIZE} ? r : null)
+  })
+  addEventListener("keydown", (event) => {
+    if (event.key === "Escape") finish(null)
+  })
+</script>
+</body>
+</html>`
+
+/**
+ * Cover a display with a dimmed overlay and let the user drag out a capture
+ * rectangle. Resolves with the rectangle relative to the display, or null if
+ * the selection was cancelled.
+ */
+export function selectRegion(display: Display): Promise<CaptureRegion | null> {
+  return new Promise((resolve) => {
+    const { x, y, width, height } = display.bounds
+    const overlay = new BrowserWindow({
+      x,
+      y,
+      width,
+      height,
+      frame: false,
+      transparent: true,
+      resizable: false,
+      movable: false,
+      fullscreenable: false,
+      hasShadow: false,
+      skipTaskbar: true,
+      enableLargerThanScreen: true,
+      backgroundColor: "#00000000",
+      webPreferences: {
+        nodeIntegration: false,
+        contextIsolation: true,
+        sandbox: true
+      }
+    })
+    // Stay above the main window, which sits at level 1
+    overlay.setAlwaysOnTop(true, "screen-saver", 2)
+    overlay.setVisibleOnAllWorkspaces(true, { visibleOnFullScreen: true })
+    overlay.setContentProtection(true)
+
+    let settled = false
+    const finish = (region: CaptureRegion | null) => {
+      if (settled) return
+      settled = true
+      if (!overlay.isDestroyed()) overlay.close()
+      resolve(region)
+    }
+
+    overlay.on("page-title-updated", (event, title) => {
+      event.preventDefault()
+      if (!title.startsWith(RESULT_PREFIX)) return
+
+      const values = title.slice(RESULT_PREFIX.length).split(",").map(Number)
+      if (values.length !== 4 || values.some((value) => !Number.isFinite(value))) {
+        finish(null)
+        return
+      }
+      const [regionX, regionY, regionWidth, regionHeight] = values
+      finish({ displayId: display.id, x: regionX, y: regionY, width: regionWidth, height: regionHeight })
+    })
+    overlay.on("blur", () => finish(null))
+    overlay.on("closed", () => finish(null))
+
+    overlay.webContents.once("did-finish-load", () => overlay.focus())
+    overlay
+      .loadURL(`data:text/html;charset=utf-8,${encodeURIComponent(SELECTOR_HTML)}`)
+      .catch((error) => {
+        console.error("Error loading region selector:", error)
+        finish(null)
+      })
+  })
+}
@@ -21,9 +21,7 @@ export class ShortcutsHelper {
     
     // Save the opacity setting to config without re-initializing the client
     try {
-      const config = configHelper.loadConfig();
-      config.opacity = newOpacity;
-      configHelper.saveConfig(config);
+      configHelper.setOpacity(newOpacity);
     } catch (error) {
       console.error('Error saving opacity to config:', error);
     }
@@ -34,21 +32,39 @@ export class ShortcutsHelper {
     }
   }
 
+  private async captureAndPreview(): Promise<void> {
+    const mainWindow = this.deps.getMainWindow()
+    if (!mainWindow) return
+
+    console.log("Taking screenshot...")
+    try {
+      const captureStartedAt = Date.now()
+      const screenshotPath = await this.deps.takeScreenshot()
+      const preview = await this.deps.getImagePreview(screenshotPath)
+      mainWindow.webContents.send("screenshot-taken", {
+        path: screenshotPath,
+        preview
+      })
+      console.log(`Capture to preview: ${Date.now() - captureStartedAt} ms`)
+    } catch (error) {
+      console.error("Error capturing screenshot:", error)
+    }
+  }
+
   public registerGlobalShortcuts(): void {
     globalShortcut.register("CommandOrControl+H", async () => {
-      const mainWindow = this.deps.getMainWindow()
-      if (mainWindow) {
-        console.log("Taking screenshot...")
-        try {
-          const screenshotPath = await this.deps.takeScreenshot()
-          const preview = await this.deps.getImagePreview(screenshotPath)
-          mainWindow.webContents.send("screenshot-taken", {
-            path: screenshotPath,
-            preview
-          })
-        } catch (error) {
-          console.error("Error capturing screenshot:", error)
+      await this.captureAndPreview()
+    })
+
+    // Draw a new capture region, then capture it straight away
+    globalShortcut.register("CommandOrControl+Shift+H", async () => {
+      console.log("Command/Ctrl + Shift + H pressed. Selecting capture region.")
+      try {
+        if (await this.deps.selectCaptureRegion()) {
+          await this.captureAndPreview()
         }
+      } catch (error) {
+        console.error("Error selecting capture region:", error)
       }
     })
 
@@ -60,10 +60,14 @@ function App() {
     window.__LANGUAGE__ = newLanguage
   }, [])
 
-  // Helper function to mark initialization complete
+  // Helper function to mark initialization complete. The main process caches
+  // what the renderer reports here instead of querying the window per request.
   const markInitialized = useCallback(() => {
     setIsInitialized(true)
-    window.__IS_INITIALIZED__ = true
+    window.electronAPI.notifyRendererReady({
+      language: window.__LANGUAGE__,
+      credits: window.__CREDITS__
+    })
   }, [])
 
   // Show toast method
@@ -204,11 +208,36 @@ function App() {
     return () => {
       window.electronAPI.removeListener("API_KEY_INVALID", onApiKeyInvalid)
       unsubscribeSolutionSuccess()
-      window.__IS_INITIALIZED__ = false
       setIsInitialized(false)
     }
   }, [updateCredits, updateLanguage, markInitialized, showToast])
 
+  // Follow language and credit changes pushed by the main process
+  useEffect(() => {
+    const unsubscribeLanguage = window.electronAPI.onLanguageChanged(updateLanguage)
+    const unsubscribeCredits = window.electronAPI.onCreditsUpdated((newCredits) => {
+      setCredits(newCredits)
+      window.__CREDITS__ = newCredits
+    })
+    return () => {
+      unsubscribeLanguage()
+      unsubscribeCredits()
+    }
+  }, [updateLanguage])
+
+  // Let the user know a repeat capture did not take up another slot
+  useEffect(() => {
+    return window.electronAPI.onScreenshotDuplicate((data) => {
+      showToast(
+        "Same screen captured",
+        data.action === "replace"
+          ? "Replaced the earlier screenshot of this screen"
+          : "This screen is already in the queue",
+        "neutral"
+      )
+    })
+  }, [showToast])
+
   // API Key dialog management
   const handleOpenSettings = useCallback(() => {
     console.log('Opening settings dialog');
@@ -11,6 +11,7 @@ import SolutionCommands from "../components/Solutions/SolutionCommands"
 import Debug from "./Debug"
 import { useToast } from "../contexts/toast"
 import { COMMAND_KEY } from "../utils/platform"
+import { traceNow, traceUntilPaint } from "../utils/tracing"
 
 export const ContentSection = ({
   title,
@@ -191,6 +192,10 @@ const Solutions: React.FC<SolutionsProps> = ({
   const [spaceComplexityData, setSpaceComplexityData] = useState<string | null>(
     null
   )
+  const [streamingText, setStreamingText] = useState("")
+  // Trace of the current run, so render spans line up with the main process ones
+  const traceIdRef = useRef<string | null>(null)
+  const firstChunkTracedRef = useRef(false)
 
   const [isTooltipVisible, setIsTooltipVisible] = useState(false)
   const [tooltipHeight, setTooltipHeight] = useState(0)
@@ -287,18 +292,32 @@ const Solutions: React.FC<SolutionsProps> = ({
 
         // Reset screenshots
         setExtraScreenshots([])
+        setStreamingText("")
 
         // After a small delay, clear the resetting state
         setTimeout(() => {
           setIsResetting(false)
         }, 0)
       }),
-      window.electronAPI.onSolutionStart(() => {
+      window.electronAPI.onSolutionStart((data) => {
+        traceIdRef.current = data?.traceId ?? null
+        firstChunkTracedRef.current = false
         // Every time processing starts, reset relevant states
         setSolutionData(null)
         setThoughtsData(null)
         setTimeComplexityData(null)
         setSpaceComplexityData(null)
+        setStreamingText("")
+      }),
+      window.electronAPI.onSolutionChunk((data) => {
+        // Only the code field is previewed; explanations arrive with the result
+        if (data.field === "code") {
+          if (!firstChunkTracedRef.current) {
+            firstChunkTracedRef.current = true
+            traceUntilPaint(traceIdRef.current, "render first code chunk", traceNow())
+          }
+          setStreamingText((prev) => prev + data.delta)
+        }
       }),
       window.electronAPI.onProblemExtracted((data) => {
         queryClient.setQueryData(["problem_statement"], data)
@@ -328,6 +347,7 @@ const Solutions: React.FC<SolutionsProps> = ({
           console.warn("Received empty or invalid solution data")
           return
         }
+        const receivedAt = traceNow()
         console.log({ data })
         const solutionData = {
           code: data.code,
@@ -337,10 +357,12 @@ const Solutions: React.FC<SolutionsProps> = ({
         }
 
         queryClient.setQueryData(["solution"], solutionData)
+        setStreamingText("")
         setSolutionData(solutionData.code || null)
         setThoughtsData(solutionData.thoughts || null)
         setTimeComplexityData(solutionData.time_complexity || null)
         setSpaceComplexityData(solutionData.space_complexity || null)
+        traceUntilPaint(traceIdRef.current, "render solution", receivedAt)
 
         // Fetch latest screenshots when solution is successful
         const fetchScreenshots = async () => {
@@ -365,14 +387,18 @@ const Solutions: React.FC<SolutionsProps> = ({
       //########################################################
       //DEBUG EVENTS
       //########################################################
-      window.electronAPI.onDebugStart(() => {
+      window.electronAPI.onDebugStart((data) => {
+        traceIdRef.current = data?.traceId ?? null
         //we'll set the debug processing state to true and use that to render a little loader
         setDebugProcessing(true)
       }),
       //the first time debugging works, we'll set the view to debug and populate the cache with the data
       window.electronAPI.onDebugSuccess((data) => {
+        const receivedAt = traceNow()
         queryClient.setQueryData(["new_solution"], data)
         setDebugProcessing(false)
+        // Covers the Debug page too, which renders inside this view and updates in the same tick
+        traceUntilPaint(traceIdRef.current, "render debug analysis", receivedAt)
       }),
       //when there was an error in the initial debugging, we'll show a toast and stop the little generating pulsing thing.
       window.electronAPI.onDebugError(() => {
@@ -463,6 +489,8 @@ const Solutions: React.FC<SolutionsProps> = ({
     }
   }
 
+  const streamingCode = streamingText.trim() ? streamingText : null
+
   return (
     <>
       {!isResetting && queryClient.getQueryData(["new_solution"]) ? (
@@ -518,6 +546,14 @@ const Solutions: React.FC<SolutionsProps> = ({
                         </p>
                       </div>
                     )}
+                    {problemStatementData && streamingCode && (
+                      <SolutionSection
+                        title="Solution"
+                        content={streamingCode}
+                        isLoading={false}
+                        currentLanguage={currentLanguage}
+                      />
+                    )}
                   </>
                 )}
 
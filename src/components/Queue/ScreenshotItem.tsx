@@ -1,6 +1,7 @@
 // src/components/ScreenshotItem.tsx
-import React from "react"
+import React, { useEffect, useState } from "react"
 import { X } from "lucide-react"
+import type { ScreenshotCrop } from "../../types/electron"
 
 interface Screenshot {
   path: string
@@ -14,12 +15,53 @@ interface ScreenshotItemProps {
   isLoading: boolean
 }
 
+// Tiles are 128x72 with object-cover, so the image is scaled to fill and
+// centered; map a crop from image fractions to tile fractions
+const TILE_ASPECT = 128 / 72
+
+function toTileRect(crop: ScreenshotCrop) {
+  const visibleWidth = Math.min(1, TILE_ASPECT / crop.aspect)
+  const visibleHeight = Math.min(1, crop.aspect / TILE_ASPECT)
+  const left = (crop.x - (1 - visibleWidth) / 2) / visibleWidth
+  const top = (crop.y - (1 - visibleHeight) / 2) / visibleHeight
+  const right = left + crop.width / visibleWidth
+  const bottom = top + crop.height / visibleHeight
+  const clamp = (value: number) => Math.max(0, Math.min(1, value))
+  return {
+    left: `${clamp(left) * 100}%`,
+    top: `${clamp(top) * 100}%`,
+    width: `${(clamp(right) - clamp(left)) * 100}%`,
+    height: `${(clamp(bottom) - clamp(top)) * 100}%`
+  }
+}
+
 const ScreenshotItem: React.FC<ScreenshotItemProps> = ({
   screenshot,
   onDelete,
   index,
   isLoading
 }) => {
+  const [crop, setCrop] = useState<ScreenshotCrop | null>(null)
+
+  // Debug outline of the area auto-crop sends; only reported when enabled in settings
+  useEffect(() => {
+    let cancelled = false
+    window.electronAPI
+      ?.getScreenshotCrop(screenshot.path)
+      .then((existing) => {
+        if (!cancelled && existing) setCrop(existing)
+      })
+      .catch(() => {})
+
+    const unsubscribe = window.electronAPI?.onScreenshotCrop((data) => {
+      if (data.path === screenshot.path) setCrop(data.crop)
+    })
+    return () => {
+      cancelled = true
+      unsubscribe?.()
+    }
+  }, [screenshot.path])
+
   const handleDelete = async () => {
     await onDelete(index)
   }
@@ -46,6 +88,12 @@ const ScreenshotItem: React.FC<ScreenshotItemProps> = ({
                 : "cursor-pointer group-hover:scale-105 group-hover:brightness-75"
             }`}
           />
+          {crop && (
+            <div
+              className="absolute border border-dashed border-green-400 pointer-events-none"
+              style={toTileRect(crop)}
+            />
+          )}
         </div>
         {!isLoading && (
           <button
@@ -15,6 +15,10 @@ import { useToast } from "../../contexts/toast";
 
 type APIProvider = "openai" | "gemini" | "anthropic";
 
+type CaptureMode = "fullDesktop" | "cursorDisplay" | "region";
+
+type DuplicateScreenshotAction = "replace" | "skip" | "keep";
+
 type AIModel = {
   id: string;
   name: string;
@@ -172,6 +176,51 @@ const modelCategories: ModelCategory[] = [
   }
 ];
 
+const CAPTURE_MODES: { id: CaptureMode; name: string; description: string }[] = [
+  { id: "fullDesktop", name: "All displays", description: "Every monitor in one image" },
+  { id: "cursorDisplay", name: "Current display", description: "The monitor under the cursor" },
+  { id: "region", name: "Saved region", description: "The last rectangle you drew" }
+];
+
+const DUPLICATE_ACTIONS: { id: DuplicateScreenshotAction; name: string }[] = [
+  { id: "replace", name: "Replace" },
+  { id: "skip", name: "Skip" },
+  { id: "keep", name: "Keep both" }
+];
+
+const PerformanceToggle = ({
+  title,
+  description,
+  enabled,
+  onToggle
+}: {
+  title: string;
+  description: string;
+  enabled: boolean;
+  onToggle: () => void;
+}) => (
+  <div
+    className={`p-2 rounded-lg cursor-pointer transition-colors ${
+      enabled
+        ? "bg-white/10 border border-white/20"
+        : "bg-black/30 border border-white/5 hover:bg-white/5"
+    }`}
+    onClick={onToggle}
+  >
+    <div className="flex items-center gap-2">
+      <div
+        className={`w-3 h-3 rounded-full ${
+          enabled ? "bg-white" : "bg-white/20"
+        }`}
+      />
+      <div>
+        <p className="font-medium text-white text-xs">{title}</p>
+        <p className="text-xs text-white/60">{description}</p>
+      </div>
+    </div>
+  </div>
+);
+
 interface SettingsDialogProps {
   open?: boolean;
   onOpenChange?: (open: boolean) => void;
@@ -184,6 +233,26 @@ export function SettingsDialog({ open: externalOpen, onOpenChange }: SettingsDia
   const [extractionModel, setExtractionModel] = useState("gpt-4o");
   const [solutionModel, setSolutionModel] = useState("gpt-4o");
   const [debuggingModel, setDebuggingModel] = useState("gpt-4o");
+  const [streamSolutions, setStreamSolutions] = useState(true);
+  const [extractionCacheEnabled, setExtractionCacheEnabled] = useState(true);
+  const [historyEnabled, setHistoryEnabled] = useState(true);
+  const [speculativeExtraction, setSpeculativeExtraction] = useState(false);
+  const [oneShotMode, setOneShotMode] = useState(false);
+  const [imageOptimization, setImageOptimization] = useState(true);
+  const [imageGrayscale, setImageGrayscale] = useState(false);
+  const [autoCrop, setAutoCrop] = useState(true);
+  const [cropOverlay, setCropOverlay] = useState(false);
+  const [ocrEnabled, setOcrEnabled] = useState(false);
+  const [hedgeEnabled, setHedgeEnabled] = useState(false);
+  const [hedgeProvider, setHedgeProvider] = useState<APIProvider>("openai");
+  const [hedgeApiKey, setHedgeApiKey] = useState("");
+  const [hedgeDelayMs, setHedgeDelayMs] = useState(1500);
+  const [tracingEnabled, setTracingEnabled] = useState(false);
+  const [captureMode, setCaptureMode] = useState<CaptureMode>("fullDesktop");
+  const [duplicateScreenshots, setDuplicateScreenshots] = useState<DuplicateScreenshotAction>("replace");
+  const [cacheStats, setCacheStats] = useState<{ hits: number; misses: number; entries: number } | null>(null);
+  const [historyStats, setHistoryStats] = useState<{ problems: number; bytes: number; hits: number; misses: number } | null>(null);
+  const [cropStats, setCropStats] = useState<{ screenshots: number; cropped: number; sourcePixels: number; keptPixels: number } | null>(null);
   const [isLoading, setIsLoading] = useState(false);
   const { showToast } = useToast();
 
@@ -213,6 +282,23 @@ export function SettingsDialog({ open: externalOpen, onOpenChange }: SettingsDia
         extractionModel?: string;
         solutionModel?: string;
         debuggingModel?: string;
+        streamSolutions?: boolean;
+        extractionCacheEnabled?: boolean;
+        historyEnabled?: boolean;
+        speculativeExtraction?: boolean;
+        oneShotMode?: boolean;
+        imageOptimization?: boolean;
+        imageGrayscale?: boolean;
+        autoCrop?: boolean;
+        cropOverlay?: boolean;
+        ocrEnabled?: boolean;
+        hedgeEnabled?: boolean;
+        hedgeProvider?: APIProvider;
+        hedgeApiKey?: string;
+        hedgeDelayMs?: number;
+        tracingEnabled?: boolean;
+        captureMode?: CaptureMode;
+        duplicateScreenshots?: DuplicateScreenshotAction;
       }
 
       window.electronAPI
@@ -223,6 +309,23 @@ export function SettingsDialog({ open: externalOpen, onOpenChange }: SettingsDia
           setExtractionModel(config.extractionModel || "gpt-4o");
           setSolutionModel(config.solutionModel || "gpt-4o");
           setDebuggingModel(config.debuggingModel || "gpt-4o");
+          setStreamSolutions(config.streamSolutions !== false);
+          setExtractionCacheEnabled(config.extractionCacheEnabled !== false);
+          setHistoryEnabled(config.historyEnabled !== false);
+          setSpeculativeExtraction(!!config.speculativeExtraction);
+          setOneShotMode(!!config.oneShotMode);
+          setImageOptimization(config.imageOptimization !== false);
+          setImageGrayscale(!!config.imageGrayscale);
+          setAutoCrop(config.autoCrop !== false);
+          setCropOverlay(!!config.cropOverlay);
+          setOcrEnabled(!!config.ocrEnabled);
+          setHedgeEnabled(!!config.hedgeEnabled);
+          setHedgeProvider(config.hedgeProvider || "openai");
+          setHedgeApiKey(config.hedgeApiKey || "");
+          setHedgeDelayMs(config.hedgeDelayMs ?? 1500);
+          setTracingEnabled(!!config.tracingEnabled);
+          setCaptureMode(config.captureMode || "fullDesktop");
+          setDuplicateScreenshots(config.duplicateScreenshots || "replace");
         })
         .catch((error: unknown) => {
           console.error("Failed to load config:", error);
@@ -231,6 +334,27 @@ export function SettingsDialog({ open: externalOpen, onOpenChange }: SettingsDia
         .finally(() => {
           setIsLoading(false);
         });
+
+      window.electronAPI
+        .getExtractionCacheStats()
+        .then(setCacheStats)
+        .catch((error: unknown) => {
+          console.error("Failed to load extraction cache stats:", error);
+        });
+
+      window.electronAPI
+        .getHistoryStats()
+        .then(setHistoryStats)
+        .catch((error: unknown) => {
+          console.error("Failed to load solve history stats:", error);
+        });
+
+      window.electronAPI
+        .getCropStats()
+        .then(setCropStats)
+        .catch((error: unknown) => {
+          console.error("Failed to load auto-crop stats:", error);
+        });
     }
   }, [open, showToast]);
 
@@ -263,6 +387,23 @@ export function SettingsDialog({ open: externalOpen, onOpenChange }: SettingsDia
         extractionModel,
         solutionModel,
         debuggingModel,
+        streamSolutions,
+        extractionCacheEnabled,
+        historyEnabled,
+        speculativeExtraction,
+        oneShotMode,
+        imageOptimization,
+        imageGrayscale,
+        autoCrop,
+        cropOverlay,
+        ocrEnabled,
+        hedgeEnabled,
+        hedgeProvider,
+        hedgeApiKey,
+        hedgeDelayMs,
+        tracingEnabled,
+        captureMode,
+        duplicateScreenshots,
       });
       
       if (result) {
@@ -467,6 +608,9 @@ export function SettingsDialog({ open: externalOpen, onOpenChange }: SettingsDia
                 <div className="text-white/70">Take Screenshot</div>
                 <div className="text-white/90 font-mono">Ctrl+H / Cmd+H</div>
                 
+                <div className="text-white/70">Select Capture Region</div>
+                <div className="text-white/90 font-mono">Ctrl+Shift+H / Cmd+Shift+H</div>
+                
                 <div className="text-white/70">Process Screenshots</div>
                 <div className="text-white/90 font-mono">Ctrl+Enter / Cmd+Enter</div>
                 
@@ -563,6 +707,187 @@ export function SettingsDialog({ open: externalOpen, onOpenChange }: SettingsDia
               );
             })}
           </div>
+
+          <div className="space-y-2 mt-4">
+            <label className="text-sm font-medium text-white">Screenshot Area</label>
+            <div className="flex gap-2">
+              {CAPTURE_MODES.map((mode) => (
+                <div
+                  key={mode.id}
+                  className={`flex-1 p-2 rounded-lg cursor-pointer transition-colors ${
+                    captureMode === mode.id
+                      ? "bg-white/10 border border-white/20"
+                      : "bg-black/30 border border-white/5 hover:bg-white/5"
+                  }`}
+                  onClick={() => setCaptureMode(mode.id)}
+                >
+                  <p className="font-medium text-white text-sm">{mode.name}</p>
+                  <p className="text-xs text-white/60">{mode.description}</p>
+                </div>
+              ))}
+            </div>
+            <p className="text-xs text-white/50">
+              Press Ctrl+Shift+H / Cmd+Shift+H to draw a new region and capture it
+            </p>
+            <div className="flex items-center gap-2">
+              <span className="text-xs text-white/70 flex-1">Capturing a screen that is already queued</span>
+              {DUPLICATE_ACTIONS.map((action) => (
+                <div
+                  key={action.id}
+                  className={`px-2 py-1 rounded-lg cursor-pointer transition-colors text-xs ${
+                    duplicateScreenshots === action.id
+                      ? "bg-white/10 border border-white/20"
+                      : "bg-black/30 border border-white/5 hover:bg-white/5"
+                  }`}
+                  onClick={() => setDuplicateScreenshots(action.id)}
+                >
+                  {action.name}
+                </div>
+              ))}
+            </div>
+          </div>
+
+          <div className="space-y-2 mt-4">
+            <label className="text-sm font-medium text-white">Performance</label>
+            <PerformanceToggle
+              title="Stream solutions"
+              description="Show code as it is generated instead of waiting for the full response"
+              enabled={streamSolutions}
+              onToggle={() => setStreamSolutions(!streamSolutions)}
+            />
+            <PerformanceToggle
+              title="Reuse problem extractions"
+              description="Skip the vision request when the same screenshots were already analyzed"
+              enabled={extractionCacheEnabled}
+              onToggle={() => setExtractionCacheEnabled(!extractionCacheEnabled)}
+            />
+            <PerformanceToggle
+              title="Remember solved problems"
+              description="Answer a problem solved before from local history, without calling the model"
+              enabled={historyEnabled}
+              onToggle={() => setHistoryEnabled(!historyEnabled)}
+            />
+            <PerformanceToggle
+              title="Speculative extraction"
+              description="Analyze screenshots in the background as soon as they are captured (uses extra API calls)"
+              enabled={speculativeExtraction}
+              onToggle={() => setSpeculativeExtraction(!speculativeExtraction)}
+            />
+            <PerformanceToggle
+              title="One-shot mode"
+              description="Read the problem and solve it in a single request instead of two"
+              enabled={oneShotMode}
+              onToggle={() => setOneShotMode(!oneShotMode)}
+            />
+            <PerformanceToggle
+              title="Optimize uploads"
+              description="Downscale and compress screenshots before sending them to the provider"
+              enabled={imageOptimization}
+              onToggle={() => setImageOptimization(!imageOptimization)}
+            />
+            <PerformanceToggle
+              title="Grayscale uploads"
+              description="Send screenshots without color for smaller payloads on text-only problems"
+              enabled={imageGrayscale}
+              onToggle={() => setImageGrayscale(!imageGrayscale)}
+            />
+            <PerformanceToggle
+              title="Crop to content"
+              description="Cut away sidebars, browser chrome and empty space around the problem before upload"
+              enabled={autoCrop}
+              onToggle={() => setAutoCrop(!autoCrop)}
+            />
+            {autoCrop && (
+              <PerformanceToggle
+                title="Show crop outline"
+                description="Outline the area that was kept on each screenshot preview"
+                enabled={cropOverlay}
+                onToggle={() => setCropOverlay(!cropOverlay)}
+              />
+            )}
+            <PerformanceToggle
+              title="Local text recognition"
+              description="Read screenshots on this machine and send the text instead of images when it is clearly legible"
+              enabled={ocrEnabled}
+              onToggle={() => setOcrEnabled(!ocrEnabled)}
+            />
+            <PerformanceToggle
+              title="Hedge requests"
+              description="Race a second provider and use whichever answers first (uses extra API calls)"
+              enabled={hedgeEnabled}
+              onToggle={() => setHedgeEnabled(!hedgeEnabled)}
+            />
+            {hedgeEnabled && (
+              <div className="space-y-2 p-2 rounded-lg bg-black/30 border border-white/5">
+                <div className="flex gap-2">
+                  {(["openai", "gemini", "anthropic"] as APIProvider[])
+                    .filter((provider) => provider !== apiProvider)
+                    .map((provider) => (
+                      <div
+                        key={provider}
+                        className={`flex-1 p-1.5 rounded-lg cursor-pointer transition-colors text-xs text-center ${
+                          hedgeProvider === provider
+                            ? "bg-white/10 border border-white/20"
+                            : "bg-black/30 border border-white/5 hover:bg-white/5"
+                        }`}
+                        onClick={() => setHedgeProvider(provider)}
+                      >
+                        {provider === "openai" ? "OpenAI" : provider === "gemini" ? "Gemini" : "Claude"}
+                      </div>
+                    ))}
+                </div>
+                <Input
+                  type="password"
+                  value={hedgeApiKey}
+                  onChange={(e) => setHedgeApiKey(e.target.value)}
+                  placeholder="API key for the hedge provider"
+                  className="bg-black/50 border-white/10 text-white"
+                />
+                <div className="flex items-center gap-2">
+                  <label className="text-xs text-white/60" htmlFor="hedgeDelay">
+                    Start after (ms)
+                  </label>
+                  <Input
+                    id="hedgeDelay"
+                    type="number"
+                    min={0}
+                    step={250}
+                    value={hedgeDelayMs}
+                    onChange={(e) => setHedgeDelayMs(Math.max(0, Number(e.target.value) || 0))}
+                    className="bg-black/50 border-white/10 text-white w-24"
+                  />
+                </div>
+                {hedgeProvider === apiProvider && (
+                  <p className="text-xs text-white/50">
+                    Choose a provider different from the primary one
+                  </p>
+                )}
+              </div>
+            )}
+            <PerformanceToggle
+              title="Record traces"
+              description="Write per-stage timings to a trace file you can open in Perfetto or chrome://tracing"
+              enabled={tracingEnabled}
+              onToggle={() => setTracingEnabled(!tracingEnabled)}
+            />
+            {cacheStats && (
+              <p className="text-xs text-white/50">
+                Extraction cache: {cacheStats.hits} hits, {cacheStats.misses} misses, {cacheStats.entries} stored
+              </p>
+            )}
+            {historyStats && historyStats.problems > 0 && (
+              <p className="text-xs text-white/50">
+                Solve history: {historyStats.problems} problems ({(historyStats.bytes / (1024 * 1024)).toFixed(1)} MB),{" "}
+                {historyStats.hits} recalled this session
+              </p>
+            )}
+            {cropStats && cropStats.sourcePixels > 0 && (
+              <p className="text-xs text-white/50">
+                Auto-crop: {cropStats.cropped} of {cropStats.screenshots} uploads cropped,{" "}
+                {Math.round((1 - cropStats.keptPixels / cropStats.sourcePixels) * 100)}% fewer pixels
+              </p>
+            )}
+          </div>
         </div>
         <DialogFooter className="flex justify-between sm:justify-between">
           <Button
@@ -31,6 +31,10 @@ export const WelcomeScreen: React.FC<WelcomeScreenProps> = ({ onOpenSettings })
                 <span className="text-white/70">Take Screenshot</span>
                 <span className="text-white/90">Ctrl+H / Cmd+H</span>
               </li>
+              <li className="flex justify-between text-sm">
+                <span className="text-white/70">Select Capture Region</span>
+                <span className="text-white/90">Ctrl+Shift+H / Cmd+Shift+H</span>
+              </li>
               <li className="flex justify-between text-sm">
                 <span className="text-white/70">Delete Last Screenshot</span>
                 <span className="text-white/90">Ctrl+L / Cmd+L</span>
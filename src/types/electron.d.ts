@@ -1,3 +1,12 @@
+// Area kept by auto-crop, as fractions of the full screenshot
+export interface ScreenshotCrop {
+  x: number
+  y: number
+  width: number
+  height: number
+  aspect: number
+}
+
 export interface ElectronAPI {
   // Original methods
   openSubscriptionPortal: (authData: {
@@ -20,14 +29,18 @@ export interface ElectronAPI {
   onScreenshotTaken: (
     callback: (data: { path: string; preview: string }) => void
   ) => () => void
+  onScreenshotDuplicate: (
+    callback: (data: { action: "replace" | "skip"; path: string; replacedPath?: string; distance: number }) => void
+  ) => () => void
   onResetView: (callback: () => void) => () => void
-  onSolutionStart: (callback: () => void) => () => void
-  onDebugStart: (callback: () => void) => () => void
+  onSolutionStart: (callback: (data?: { traceId: string | null }) => void) => () => void
+  onDebugStart: (callback: (data?: { traceId: string | null }) => void) => () => void
   onDebugSuccess: (callback: (data: any) => void) => () => void
   onSolutionError: (callback: (error: string) => void) => () => void
   onProcessingNoScreenshots: (callback: () => void) => () => void
   onProblemExtracted: (callback: (data: any) => void) => () => void
   onSolutionSuccess: (callback: (data: any) => void) => () => void
+  onSolutionChunk: (callback: (data: { field: string; delta: string }) => void) => () => void
   onUnauthorized: (callback: () => void) => () => void
   onDebugError: (callback: (error: string) => void) => () => void
   openExternal: (url: string) => void
@@ -46,6 +59,8 @@ export interface ElectronAPI {
   onUpdateAvailable: (callback: (info: any) => void) => () => void
   onUpdateDownloaded: (callback: (info: any) => void) => () => void
 
+  notifyRendererReady: (state: { language: string; credits: number }) => void
+  onLanguageChanged: (callback: (language: string) => void) => () => void
   decrementCredits: () => Promise<void>
   setInitialCredits: (credits: number) => Promise<void>
   onCreditsUpdated: (callback: (credits: number) => void) => () => void
@@ -57,6 +72,16 @@ export interface ElectronAPI {
   getConfig: () => Promise<{ apiKey: string; model: string }>
   updateConfig: (config: { apiKey?: string; model?: string }) => Promise<boolean>
   checkApiKey: () => Promise<boolean>
+  getExtractionCacheStats: () => Promise<{ hits: number; misses: number; entries: number }>
+  clearExtractionCache: () => Promise<{ success: boolean; error?: string }>
+  getHistoryStats: () => Promise<{ problems: number; bytes: number; hits: number; misses: number }>
+  clearHistory: () => Promise<{ success: boolean; error?: string }>
+  getScreenshotCrop: (path: string) => Promise<ScreenshotCrop | null>
+  getCropStats: () => Promise<{ screenshots: number; cropped: number; sourcePixels: number; keptPixels: number } | null>
+  onScreenshotCrop: (callback: (data: { path: string; crop: ScreenshotCrop }) => void) => () => void
+  reportTraceSpans: (
+    spans: Array<{ traceId: string; name: string; lane: string; start: number; duration: number }>
+  ) => Promise<void>
   validateApiKey: (apiKey: string) => Promise<{ valid: boolean; error?: string }>
   openLink: (url: string) => void
   onApiKeyInvalid: (callback: () => void) => () => void
@@ -77,7 +102,6 @@ declare global {
     }
     __CREDITS__: number
     __LANGUAGE__: string
-    __IS_INITIALIZED__: boolean
     __AUTH_TOKEN__?: string | null
   }
 }
@@ -1,5 +1,4 @@
 interface Window {
-  __IS_INITIALIZED__: boolean
   __CREDITS__: number
   __LANGUAGE__: string
   __AUTH_TOKEN__: string | null
@@ -0,0 +1,24 @@
+// Epoch milliseconds on the same timeline as the main process tracer
+export const traceNow = () => performance.timeOrigin + performance.now()
+
+// Report a span that ends once the browser has painted the current update.
+// Two animation frames: the first runs before paint, the second after it.
+export const traceUntilPaint = (
+  traceId: string | null | undefined,
+  name: string,
+  start: number
+) => {
+  if (!traceId) return
+
+  requestAnimationFrame(() => {
+    requestAnimationFrame(() => {
+      window.electronAPI
+        ?.reportTraceSpans([
+          { traceId, name, lane: "render", start, duration: traceNow() - start }
+        ])
+        .catch(() => {
+          // Tracing must never affect the UI
+        })
+    })
+  })
+}